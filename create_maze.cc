@@ -1,14 +1,122 @@
+#include <cstdlib>
+
 #include "maze.h"
+#include "maze_generator.h"
+#include "maze_solver.h"
+
+// Moves "--name value" options and "--flag" switches out of argv into options and keeps the
+// remaining positional arguments in order.
+// @return false if an option is unknown or its value is invalid.
+bool ParseOptions(int argc, char **argv, MazeOptions* options,
+                  vector<string>* positional) {
+  for (int i = 1; i < argc; ++i) {
+    const string arg = argv[i];
+    if (arg.compare(0, 2, "--") != 0) {
+      positional->push_back(arg);
+      continue;
+    }
+    if (arg == "--stream") {
+      options->stream = true;
+      continue;
+    }
+    if (arg == "--paths") {
+      options->query_paths = true;
+      continue;
+    }
+    if (arg == "--stats") {
+      options->stats = true;
+      continue;
+    }
+    if (i + 1 >= argc) {
+      printf("ERROR: option %s needs a value.\n", arg.c_str());
+      return false;
+    }
+    const string value = argv[++i];
+    if (arg == "--threads") {
+      if (!IsUnsignedNumber(value) || StringToSizeT(value) == 0) {
+        printf("ERROR: --threads must be a positive integer.\n");
+        return false;
+      }
+      options->num_threads = StringToSizeT(value);
+    } else if (arg == "--tile-size") {
+      if (!IsUnsignedNumber(value) || value.size() > 5
+          || StringToSizeT(value) == 0 || StringToSizeT(value) > 65535) {
+        printf("ERROR: --tile-size must be an integer from 1 to 65535.\n");
+        return false;
+      }
+      options->tile_size = StringToSizeT(value);
+    } else if (arg == "--seed") {
+      if (!IsUnsignedNumber(value) || value.size() > 19) {
+        printf("ERROR: --seed must be an unsigned integer below 10^19.\n");
+        return false;
+      }
+      options->seed = StringToSizeT(value);
+    } else if (arg == "--algorithm") {
+      if (!MakeGenerator(value, *options)) {
+        printf("ERROR: unknown algorithm %s.\n", value.c_str());
+        return false;
+      }
+      options->algorithm = value;
+    } else if (arg == "--braid") {
+      char* end = nullptr;
+      const double fraction = strtod(value.c_str(), &end);
+      if (value.empty() || *end != '\0' || !(fraction >= 0 && fraction <= 1)) {
+        printf("ERROR: --braid must be a number from 0 to 1.\n");
+        return false;
+      }
+      options->braid = fraction;
+    } else if (arg == "--solver") {
+      if (!MakeSolver(value)) {
+        printf("ERROR: unknown solver %s.\n", value.c_str());
+        return false;
+      }
+      options->solver = value;
+    } else if (arg == "--queries") {
+      options->queries = value;
+    } else if (arg == "--query-output") {
+      options->query_output = value;
+    } else if (arg == "--query-images") {
+      options->query_images = value;
+    } else if (arg == "--heatmap") {
+      options->heatmap = value;
+    } else if (arg == "--distances") {
+      options->distances = value;
+    } else if (arg == "--path-output") {
+      options->path_output = value;
+    } else if (arg == "--format") {
+      if (value != "pgm" && value != "packed" && value != "png") {
+        printf("ERROR: unknown format %s.\n", value.c_str());
+        return false;
+      }
+      options->format = value;
+    } else {
+      printf("ERROR: unknown option %s.\n", arg.c_str());
+      return false;
+    }
+  }
+  if (options->tile_size != 0 && options->algorithm != "kruskal") {
+    printf("ERROR: --tile-size only applies to --algorithm kruskal.\n");
+    return false;
+  }
+  return true;
+}
 
 int main(int argc, char **argv){
-  if (argc == 10) {
-    GenerateMaze( argv[1],argv[2],argv[3],
-                  argv[4],argv[5],argv[6],
-                  argv[7],argv[8],argv[9]);
-  } else if (argc == 5) {
-    GenerateMaze(argv[1],argv[2],argv[3],argv[4]);
-  } else if (argc == 1) {
-    GenerateMaze();
+  MazeOptions options;
+  vector<string> args;
+  if (!ParseOptions(argc, argv, &options, &args)) {
+    printf("ERROR: invalid arguments, please refer to README.txt.\n");
+    return 0;
+  }
+
+  if (args.size() == 9) {
+    GenerateMaze( args[0],args[1],args[2],
+                  args[3],args[4],args[5],
+                  args[6],args[7],args[8], options);
+  } else if (args.size() == 4) {
+    GenerateMaze(args[0],args[1],args[2],args[3], options);
+  } else if (args.empty()) {
+    GenerateMaze(options);
   } else {
     printf("ERROR: invalid arguments, please refer to README.txt.\n");
   }
@@ -4,79 +4,56 @@
 #include "disjoint_set.h"
 using namespace std;
 
-DisjSets::DisjSets() {}
-/**
- * Construct the disjoint sets object.
- * numElements is the initial number of disjoint sets.
- */
-DisjSets::DisjSets( const int& numElements ) : set_(numElements, -1) {}
-DisjSets::DisjSets( int&& numElements ) : set_(std::move(numElements), -1) {}
-
-/**
- * Union two disjoint sets.
- * For simplicity, we assume root1 and root2 are distinct
- * and represent set names.
- * root1 is the root of set 1.
- * root2 is the root of set 2.
- * rank of height doesn't change because we union by rank of height
- */
-void DisjSets::UnionSets( int root1, int root2 ) {
-    if (root1 == root2) {
-      return;
-    }
-    if( set_[ root2 ] < set_[ root1 ] ) { // root2 is deeper
-        set_[ root1 ] = root2; // Make root2 new root
-    } else {
-        if( set_[ root1 ] == set_[ root2 ] )
-            --set_[ root1 ];          // Update height if same
-        set_[ root2 ] = root1;        // Make root1 new root
-    }
-}
-
-
-/**
- * Perform a find.
- * Error checks omitted again for simplicity.
- * Return the set containing x.
-
-int DisjSets::find( int x ) const {
-    if( set_[ x ] < 0 )
-        return x;
-    else
-        return find( set_[ x ] );
-}
- */
-size_t DisjSets::Find( const size_t& x ) const {
-  if( set_[ x ] < 0 )
-      return x;
-  else
-      return Find( set_[ x ] ); // automatically calls mutator find
+template class BasicDisjSets<uint64_t, FullCompression, UnionByRank>;
+template class BasicDisjSets<uint32_t, FullCompression, UnionByRank>;
+
+ConcurrentDisjSets::ConcurrentDisjSets( const size_t& numElements )
+    : size_(numElements), parent_(new atomic<size_t>[numElements]) {
+  for(size_t i = 0; i < size_; ++i) {
+    parent_[i].store(i, memory_order_relaxed);
+  }
 }
 
 /**
- * Perform a find with path compression.
- * Error checks omitted again for simplicity.
- * Return the set containing x.
+ * Perform a find with path splitting.
+ * Every visited node is pointed at its grandparent with a CAS, then the walk
+ * moves on to its old parent; a failed CAS only means another thread already
+ * shortened the path.
  */
-size_t DisjSets::Find( const size_t& x) {
-    if( set_[ x ] < 0 )
-        return x;
-    else
-        return set_[ x ] = Find( set_[ x ] ); // automatically calls mutator find
-}
-
-void DisjSets::Print() const {
-	for(const auto& i: set_) {
-		cout << i << ' ';
-	}
-	cout << endl;
+size_t ConcurrentDisjSets::Find( size_t x ) {
+  while(true) {
+    size_t parent = parent_[x].load(memory_order_acquire);
+    size_t grandparent = parent_[parent].load(memory_order_acquire);
+    if(parent == grandparent) {
+      return parent;
+    }
+    parent_[x].compare_exchange_weak(parent, grandparent,
+                                     memory_order_release,
+                                     memory_order_relaxed);
+    x = parent;
+  }
 }
 
-size_t DisjSets::Size() const {
-	return set_.size();
+bool ConcurrentDisjSets::UnionSets( size_t x, size_t y ) {
+  while(true) {
+    x = Find(x);
+    y = Find(y);
+    if(x == y) {
+      return false;
+    }
+    if(x > y) {
+      swap(x, y);
+    }
+    // x is only linked if it is still a root, otherwise retry from the top.
+    size_t expected = x;
+    if(parent_[x].compare_exchange_strong(expected, y,
+                                          memory_order_acq_rel,
+                                          memory_order_acquire)) {
+      return true;
+    }
+  }
 }
 
-DisjSets& DisjSets::operator=(const DisjSets& rhs) {
-	set_ = rhs.set_;
-  return *this;
+size_t ConcurrentDisjSets::Size() const {
+  return size_;
 }
@@ -3,41 +3,199 @@
 #ifndef DISJ_SETS_H
 #define DISJ_SETS_H
 
-// DisjSets class
+// BasicDisjSets class
 //
-// CONSTRUCTION: with int representing initial number of sets
+// CONSTRUCTION: with the initial number of sets
+//
+// TEMPLATE PARAMETERS
+// Index       --> unsigned element type, uint32_t up to 2^32-1 elements
+// FindPolicy  --> FullCompression, PathHalving or PathSplitting
+// UnionPolicy --> UnionByRank or UnionBySize
 //
 // ******************PUBLIC OPERATIONS*********************
-// void union( root1, root2 ) --> Merge two sets
-// int find( x )              --> Return set containing x
+// void UnionSets( root1, root2 ) --> Merge two sets
+// Index Find( x )                --> Return set containing x
 // ******************ERRORS********************************
 // No error checking is performed
 
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <memory>
 #include <vector>
 using namespace std;
 
+// Find policies. Each walks from x to its root iteratively, so long chains
+// cannot overflow the stack, and shortens the path in its own way.
+
+// Two passes, every node on the path ends up pointing at the root.
+struct FullCompression {
+  template <typename Index>
+  static Index Find(vector<Index>* parent, Index x) {
+    Index root = x;
+    while((*parent)[root] != root) {
+      root = (*parent)[root];
+    }
+    Index next;
+    while((*parent)[x] != root) {
+      next = (*parent)[x];
+      (*parent)[x] = root;
+      x = next;
+    }
+    return root;
+  }
+};
+
+// One pass, every other node on the path points at its grandparent.
+struct PathHalving {
+  template <typename Index>
+  static Index Find(vector<Index>* parent, Index x) {
+    while((*parent)[x] != x) {
+      (*parent)[x] = (*parent)[(*parent)[x]];
+      x = (*parent)[x];
+    }
+    return x;
+  }
+};
+
+// One pass, every node on the path points at its grandparent.
+struct PathSplitting {
+  template <typename Index>
+  static Index Find(vector<Index>* parent, Index x) {
+    Index next;
+    while((*parent)[x] != x) {
+      next = (*parent)[x];
+      (*parent)[x] = (*parent)[next];
+      x = next;
+    }
+    return x;
+  }
+};
+
+// Union policies. Link makes one root the parent of the other.
+
+// The root of lower rank goes under the other, one byte per element.
+template <typename Index>
+class UnionByRank {
+  public:
+    void Reset(const size_t& numElements) { rank_.assign(numElements, 0); }
+    void Link(vector<Index>* parent, const Index& root1, const Index& root2) {
+      if(rank_[root2] > rank_[root1]) {   // root2 is deeper
+        (*parent)[root1] = root2;         // Make root2 new root
+      } else {
+        if(rank_[root1] == rank_[root2])
+          ++rank_[root1];                 // Update height if same
+        (*parent)[root2] = root1;         // Make root1 new root
+      }
+    }
+
+  private:
+    vector<uint8_t> rank_;
+};
+
+// The smaller set goes under the larger one, one Index per element.
+template <typename Index>
+class UnionBySize {
+  public:
+    void Reset(const size_t& numElements) { size_.assign(numElements, 1); }
+    void Link(vector<Index>* parent, const Index& root1, const Index& root2) {
+      if(size_[root2] > size_[root1]) {
+        (*parent)[root1] = root2;
+        size_[root2] += size_[root1];
+      } else {
+        (*parent)[root2] = root1;
+        size_[root1] += size_[root2];
+      }
+    }
+
+  private:
+    vector<Index> size_;
+};
+
 /**
  * Disjoint set class.
- * Use union by rank and path compression.
+ * Every element stores the index of its parent; a root is its own parent.
  * Elements in the set are numbered starting at 0.
  */
-class DisjSets
+template <typename Index = uint64_t, typename FindPolicy = FullCompression,
+          template <typename> class UnionPolicy = UnionByRank>
+class BasicDisjSets
 {
   public:
-    explicit DisjSets();
-    explicit DisjSets( const int& numElements );
-    explicit DisjSets( int&& numElements );
-    // int find( int x ) const;
-    size_t Find( const size_t& x ) const;
-    size_t Find( const size_t& x );
-    void UnionSets( int root1, int root2 );
-    void Print() const;
-    // void link(const size_t& e1, const size_t& e2);
+    BasicDisjSets() {}
+    // numElements is the initial number of disjoint sets.
+    explicit BasicDisjSets( const size_t& numElements ) : set_(numElements) {
+      for(size_t i = 0; i < numElements; ++i) {
+        set_[i] = static_cast<Index>(i);
+      }
+      union_.Reset(numElements);
+    }
+
+    // Find without path compression.
+    Index Find( Index x ) const {
+      while(set_[x] != x) {
+        x = set_[x];
+      }
+      return x;
+    }
+    // Find that shortens the path according to FindPolicy.
+    Index Find( const Index& x ) {
+      return FindPolicy::Find(&set_, x);
+    }
+    /**
+     * Union two disjoint sets.
+     * root1 is the root of set 1.
+     * root2 is the root of set 2.
+     */
+    void UnionSets( const Index& root1, const Index& root2 ) {
+      if(root1 != root2) {
+        union_.Link(&set_, root1, root2);
+      }
+    }
+    void Print() const {
+      for(const auto& i: set_) {
+        cout << i << ' ';
+      }
+      cout << endl;
+    }
+    size_t Size() const { return set_.size(); }
+
+  private:
+    vector<Index> set_;
+    UnionPolicy<Index> union_;
+};
+
+// Default for mazes: 64 bit indices so any maze that fits in memory fits
+// here, with the policies that maze_benchmark found fastest for Kruskal.
+typedef BasicDisjSets<uint64_t, FullCompression, UnionByRank> DisjSets;
+extern template class BasicDisjSets<uint64_t, FullCompression, UnionByRank>;
+// For sets known to stay below 2^32 elements, such as generation tiles.
+typedef BasicDisjSets<uint32_t, FullCompression, UnionByRank> SmallDisjSets;
+extern template class BasicDisjSets<uint32_t, FullCompression, UnionByRank>;
+
+/**
+ * Lock-free disjoint set class for concurrent unions.
+ * Every element stores its parent index; a root is its own parent.
+ * Find uses path splitting with CAS and roots are linked by index (lower
+ * index under higher) so concurrent links can never form a cycle.
+ * Find and UnionSets may be called from any number of threads at once.
+ */
+class ConcurrentDisjSets
+{
+  public:
+    explicit ConcurrentDisjSets( const size_t& numElements );
+    ConcurrentDisjSets(const ConcurrentDisjSets&) = delete;
+    ConcurrentDisjSets& operator=(const ConcurrentDisjSets&) = delete;
+
+    size_t Find( size_t x );
+    // Unites the sets containing x and y, which need not be roots.
+    // @return true if x and y were in different sets.
+    bool UnionSets( size_t x, size_t y );
     size_t Size() const;
-    DisjSets& operator=(const DisjSets& rhs);
 
   private:
-    vector<int> set_;
+    size_t size_;
+    unique_ptr<atomic<size_t>[]> parent_;
 };
 
 #endif
@@ -1,86 +1,18 @@
 // Created by Ioannis Stamos
 // Modified by Wei Shi
+#include <algorithm>
 #include <iostream>
 #include <string.h>
+#include <thread>
+#include <zlib.h>
 #include "image.h"
 
 using namespace std;
 
 namespace image {
 
-Image::Image(const Image &an_image){
-  AllocateSpaceAndSetSize(an_image.num_rows(), an_image.num_columns());
-  SetNumberGrayLevels(an_image.num_gray_levels());
-  for (size_t i = 0; i < num_rows(); ++i)
-    for (size_t j = 0; j < num_columns(); ++j){
-      SetPixel(i,j, an_image.GetPixel(i,j));
-    }
-}
-Image::Image(Image &&an_image) {
-  AllocateSpaceAndSetSize(std::move(an_image.num_rows()), std::move(an_image.num_columns()));
-  SetNumberGrayLevels(std::move(an_image.num_gray_levels()));
-  for (size_t i = 0; i < num_rows(); ++i)
-    for (size_t j = 0; j < num_columns(); ++j){
-      SetPixel(i,j, std::move(an_image.GetPixel(i,j)));
-    }
-}
-
-Image::~Image(){
-  DeallocateSpace();
-}
-
-Image& Image::operator=(const Image& rhs) {
-  AllocateSpaceAndSetSize(rhs.num_rows(), rhs.num_columns());
-
-  SetNumberGrayLevels(rhs.num_gray_levels());
-  for (size_t i = 0; i < num_rows(); ++i) {
-    for (size_t j = 0; j < num_columns(); ++j){
-      SetPixel(i,j,rhs.GetPixel(i,j));
-    }
-  }
-
-  return *this;
-}
-Image& Image::operator=(Image&& rhs) {
-  AllocateSpaceAndSetSize(std::move(rhs.num_rows()), std::move(rhs.num_columns()));
-  SetNumberGrayLevels(std::move(rhs.num_gray_levels()));
-
-  for (size_t i = 0; i < num_rows(); ++i) {
-    for (size_t j = 0; j < num_columns(); ++j){
-      SetPixel(i,j,std::move(rhs.GetPixel(i,j)));
-    }
-  }
-  return *this;
-}
+template class BasicImage<uint8_t>;
 
-void Image::AllocateSpaceAndSetSize(size_t num_rows, size_t num_columns) {
- if (pixels_ != nullptr){
-    DeallocateSpace();
-  }
-  pixels_ = new int*[num_rows];
-  for (size_t i = 0; i < num_rows; ++i)
-    pixels_[i] = new int[num_columns];
-
-  num_rows_ = num_rows;
-  num_columns_ = num_columns;
-}
-
-void Image::DeallocateSpace() {
-  for (size_t i = 0; i < num_rows_; i++)
-    delete pixels_[i];
-  delete pixels_;
-  pixels_ = nullptr;
-  num_rows_ = 0;
-  num_columns_ = 0;
-}
-
-void Image::Fill(unsigned short value) {
-  for(size_t i = 0; i < num_rows_; ++i) {
-    for(size_t j = 0; j < num_columns_; ++j) {
-      SetPixel(i,j,value);
-    }
-  }
-}
 bool ReadImage(const string &filename, Image *an_image) {
   if (an_image == nullptr) abort();
   FILE *input = fopen(filename.c_str(),"rb");
@@ -114,17 +46,12 @@ bool ReadImage(const string &filename, Image *an_image) {
   sscanf(line,"%d\n", &levels);
   an_image->SetNumberGrayLevels(levels);
 
-  // read pixel row by row.
-  for (int i = 0; i < num_rows; ++i) {
-    for (int j = 0;j < num_columns; ++j) {
-      const int byte=fgetc(input);
-      if (byte == EOF) {
-        fclose(input);
-        cout << "ReadImage: short file" << endl;
-        return false;
-      }
-      an_image->SetPixel(i, j, byte);
-    }
+  // the raster is the pixel buffer byte for byte.
+  const size_t size = an_image->size();
+  if (size > 0 && fread(an_image->data(), 1, size, input) != size) {
+    fclose(input);
+    cout << "ReadImage: short file" << endl;
+    return false;
   }
 
   fclose(input);
@@ -137,24 +64,20 @@ bool WriteImage(const string &filename, const Image &an_image) {
     cout << "WriteImage: cannot open file" << endl;
     return false;
   }
-  const int num_rows = an_image.num_rows();
-  const int num_columns = an_image.num_columns();
+  const size_t num_rows = an_image.num_rows();
+  const size_t num_columns = an_image.num_columns();
   const int colors = an_image.num_gray_levels();
 
   // Write the header.
   fprintf(output, "P5\n"); // Magic number.
   fprintf(output, "#\n");  // Empty comment.
-  fprintf(output, "%d %d\n%03d\n", num_columns, num_rows, colors);
-
-  for (int i = 0; i < num_rows; ++i) {
-    for (int j = 0; j < num_columns; ++j) {
-      const int byte = an_image.GetPixel(i , j);
-      if (fputc(byte,output) == EOF) {
-	    fclose(output);
-            cout << "WriteImage: could not write" << endl;
-	    return false;
-      }
-    }
+  fprintf(output, "%zu %zu\n%03d\n", num_columns, num_rows, colors);
+
+  if (an_image.size() > 0
+      && fwrite(an_image.data(), 1, an_image.size(), output) != an_image.size()) {
+    fclose(output);
+    cout << "WriteImage: could not write" << endl;
+    return false;
   }
 
   fclose(output);
@@ -162,6 +85,292 @@ bool WriteImage(const string &filename, const Image &an_image) {
 }
 
 
+RasterWriter::~RasterWriter() {
+  if (output_ != nullptr) fclose(output_);
+}
+
+bool RasterWriter::Open(const string &filename, const string &header,
+                        size_t num_rows, size_t row_bytes) {
+  if (output_ != nullptr) fclose(output_);
+  output_ = fopen(filename.c_str(), "w");
+  if (output_ == 0) {
+    cout << name_ << ": cannot open file" << endl;
+    return false;
+  }
+  setvbuf(output_, nullptr, _IOFBF, 1 << 20);
+  num_rows_ = num_rows;
+  row_bytes_ = row_bytes;
+  rows_written_ = 0;
+  return WriteBytes(header.data(), header.size());
+}
+
+bool RasterWriter::WriteRow(const unsigned char *row) {
+  if (output_ == nullptr || rows_written_ >= num_rows_) {
+    cout << name_ << ": too many rows" << endl;
+    return false;
+  }
+  if (!EncodeRow(row)) return false;
+  ++rows_written_;
+  return true;
+}
+
+bool RasterWriter::EncodeRow(const unsigned char *row) {
+  return WriteBytes(row, row_bytes_);
+}
+
+bool RasterWriter::WriteBytes(const void *data, size_t size) {
+  if (fwrite(data, 1, size, output_) != size) {
+    cout << name_ << ": could not write" << endl;
+    return false;
+  }
+  return true;
+}
+
+bool RasterWriter::Close() {
+  if (output_ == nullptr) return false;
+  const bool finished = Finish();
+  const bool ok = fclose(output_) == 0 && rows_written_ == num_rows_ && finished;
+  output_ = nullptr;
+  if (!ok) cout << name_ << ": short file" << endl;
+  return ok;
+}
 
+bool PgmWriter::Open(const string &filename, size_t num_rows,
+                     size_t num_columns, unsigned short gray_levels) {
+  // Same header as WriteImage.
+  char header[80];
+  snprintf(header, sizeof(header), "P5\n#\n%zu %zu\n%03d\n", num_columns,
+           num_rows, gray_levels);
+  return RasterWriter::Open(filename, header, num_rows, num_columns);
+}
+
+bool PbmWriter::Open(const string &filename, size_t num_rows,
+                     size_t num_columns) {
+  char header[80];
+  snprintf(header, sizeof(header), "P4\n#\n%zu %zu\n", num_columns, num_rows);
+  return RasterWriter::Open(filename, header, num_rows, (num_columns + 7) / 8);
+}
+
+namespace {
+
+// Appends value to bytes in little endian order, size bytes of it.
+void AppendLittleEndian(uint32_t value, size_t size, string *bytes) {
+  for (size_t i = 0; i < size; ++i) {
+    bytes->push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+  }
+}
+
+// Writes value to bytes in big endian order, the order of png.
+void PutBigEndian(uint32_t value, unsigned char *bytes) {
+  bytes[0] = (value >> 24) & 0xff;
+  bytes[1] = (value >> 16) & 0xff;
+  bytes[2] = (value >> 8) & 0xff;
+  bytes[3] = value & 0xff;
+}
+
+// Size of the deflate window, the most a block can refer back.
+const size_t kWindowBytes = 32768;
+
+// Deflates raw at zlib level, primed with the window before it, into
+// compressed as raw deflate data ending on a sync flush, or on the final
+// block if last.
+// Returns true if everything is OK, false otherwise.
+bool DeflateBlock(const unsigned char *window, size_t window_size,
+                  const vector<unsigned char> &raw, int level, bool last,
+                  vector<unsigned char> *compressed) {
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (deflateInit2(&stream, level, Z_DEFLATED, -15, 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    return false;
+  }
+  if (window_size > 0
+      && deflateSetDictionary(&stream, window, window_size) != Z_OK) {
+    deflateEnd(&stream);
+    return false;
+  }
+  compressed->resize(deflateBound(&stream, raw.size()) + 16);
+  stream.next_in = const_cast<unsigned char *>(raw.data());
+  stream.avail_in = raw.size();
+  int status;
+  do {
+    if (stream.total_out == compressed->size()) {
+      compressed->resize(2 * compressed->size());
+    }
+    stream.next_out = compressed->data() + stream.total_out;
+    stream.avail_out = compressed->size() - stream.total_out;
+    status = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+  } while (status == Z_OK && (last || stream.avail_out == 0));
+  compressed->resize(stream.total_out);
+  deflateEnd(&stream);
+  return last ? status == Z_STREAM_END : status == Z_OK || status == Z_BUF_ERROR;
+}
+
+}  // namespace
+
+bool BmpWriter::Open(const string &filename, size_t num_rows,
+                     size_t num_columns,
+                     const vector<unsigned char> &palette) {
+  const size_t row_bytes = BmpRowBytes(num_columns);
+  const size_t offset = 14 + 40 + 4 * palette.size();
+  if (palette.size() > 16 || num_columns > INT32_MAX || num_rows > INT32_MAX
+      || offset + row_bytes * num_rows > UINT32_MAX) {
+    cout << "BmpWriter: image too large" << endl;
+    return false;
+  }
+  string header = "BM";
+  AppendLittleEndian(offset + row_bytes * num_rows, 4, &header); // file size
+  AppendLittleEndian(0, 4, &header); // reserved
+  AppendLittleEndian(offset, 4, &header); // where the pixels start
+  AppendLittleEndian(40, 4, &header); // BITMAPINFOHEADER
+  AppendLittleEndian(num_columns, 4, &header);
+  // a negative height puts the top row first.
+  AppendLittleEndian(static_cast<uint32_t>(-static_cast<int32_t>(num_rows)), 4,
+                     &header);
+  AppendLittleEndian(1, 2, &header); // planes
+  AppendLittleEndian(4, 2, &header); // bits per pixel
+  AppendLittleEndian(0, 4, &header); // no compression
+  AppendLittleEndian(row_bytes * num_rows, 4, &header);
+  AppendLittleEndian(2835, 4, &header); // 72 dpi across
+  AppendLittleEndian(2835, 4, &header); // and down
+  AppendLittleEndian(palette.size(), 4, &header); // colors used
+  AppendLittleEndian(0, 4, &header); // all of them important
+  for (const unsigned char &gray : palette) {
+    const uint32_t level = gray;
+    AppendLittleEndian(level | (level << 8) | (level << 16), 4, &header);
+  }
+  return RasterWriter::Open(filename, header, num_rows, row_bytes);
+}
+
+bool PngWriter::Open(const string &filename, size_t num_rows,
+                     size_t num_columns) {
+  if (num_rows == 0 || num_columns == 0 || num_rows > INT32_MAX
+      || num_columns > INT32_MAX) {
+    cout << "PngWriter: bad image size" << endl;
+    return false;
+  }
+  used_ = 0;
+  previous_.clear();
+  window_.clear();
+  adler_ = adler32(0, nullptr, 0);
+  started_ = false;
+  string header = "\x89PNG\r\n\x1a\n";
+  unsigned char ihdr[13];
+  PutBigEndian(num_columns, ihdr);
+  PutBigEndian(num_rows, ihdr + 4);
+  ihdr[8] = 8; // bits per pixel
+  ihdr[9] = 0; // grayscale
+  ihdr[10] = 0; // deflate
+  ihdr[11] = 0; // adaptive filters
+  ihdr[12] = 0; // not interlaced
+  return RasterWriter::Open(filename, header, num_rows, num_columns)
+         && WriteChunk("IHDR", ihdr, sizeof(ihdr));
+}
+
+bool PngWriter::EncodeRow(const unsigned char *row) {
+  const size_t width = row_bytes();
+  if (used_ == 0 || blocks_[used_ - 1].raw.size() >= kBlockBytes) {
+    if (used_ == num_threads_ && !WriteBlocks(false)) return false;
+    if (blocks_.size() == used_) blocks_.emplace_back();
+    blocks_[used_++].raw.clear();
+  }
+  vector<unsigned char> &raw = blocks_[used_ - 1].raw;
+  const size_t at = raw.size();
+  raw.resize(at + 1 + width);
+  unsigned char *out = raw.data() + at + 1;
+  if (!previous_.empty() && memcmp(row, previous_.data(), width) == 0) {
+    out[-1] = 2; // Up, every byte minus the one above is zero
+    memset(out, 0, width);
+  } else {
+    out[-1] = 1; // Sub, every byte minus the one to its left
+    out[0] = row[0];
+    for (size_t i = 1; i < width; ++i) {
+      out[i] = row[i] - row[i - 1];
+    }
+    previous_.assign(row, row + width);
+  }
+  return true;
+}
+
+bool PngWriter::Finish() {
+  if (used_ == 0) {
+    if (blocks_.empty()) blocks_.emplace_back();
+    blocks_[used_++].raw.clear();
+  }
+  unsigned char end[1];
+  return WriteBlocks(true) && WriteChunk("IEND", end, 0);
+}
+
+bool PngWriter::WriteBlocks(bool last) {
+  // block b refers back into the block before it, or into window_.
+  auto deflate_block = [&](size_t b) {
+    const vector<unsigned char> &before = b == 0 ? window_ : blocks_[b - 1].raw;
+    const size_t window_size = min(kWindowBytes, before.size());
+    Block &block = blocks_[b];
+    block.ok = DeflateBlock(before.data() + before.size() - window_size,
+                            window_size, block.raw, level_, last && b + 1 == used_,
+                            &block.compressed);
+    block.adler = adler32(adler32(0, nullptr, 0), block.raw.data(),
+                          block.raw.size());
+  };
+  vector<thread> threads;
+  for (size_t b = 1; b < used_; ++b) {
+    threads.emplace_back(deflate_block, b);
+  }
+  deflate_block(0);
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  bool ok = true;
+  for (size_t b = 0; b < used_ && ok; ++b) {
+    Block &block = blocks_[b];
+    adler_ = adler32_combine(adler_, block.adler, block.raw.size());
+    if (!started_) {
+      // zlib header: deflate with a 32KB window, no dictionary.
+      const unsigned char zlib_header[2] = {0x78, 0x9c};
+      block.compressed.insert(block.compressed.begin(), zlib_header,
+                              zlib_header + 2);
+      started_ = true;
+    }
+    if (last && b + 1 == used_) {
+      unsigned char adler[4];
+      PutBigEndian(adler_, adler);
+      block.compressed.insert(block.compressed.end(), adler, adler + 4);
+    }
+    ok = block.ok && WriteChunk("IDAT", block.compressed.data(),
+                                block.compressed.size());
+  }
+  const vector<unsigned char> &tail = blocks_[used_ - 1].raw;
+  window_.assign(tail.end() - min(kWindowBytes, tail.size()), tail.end());
+  used_ = 0;
+  if (!ok) cout << "PngWriter: could not compress" << endl;
+  return ok;
+}
+
+bool PngWriter::WriteChunk(const char *type, const unsigned char *data,
+                           size_t size) {
+  unsigned char length[4];
+  unsigned char crc[4];
+  PutBigEndian(size, length);
+  uLong check = crc32(0, nullptr, 0);
+  check = crc32(check, reinterpret_cast<const Bytef *>(type), 4);
+  check = crc32(check, data, size);
+  PutBigEndian(check, crc);
+  return WriteBytes(length, 4) && WriteBytes(type, 4)
+         && WriteBytes(data, size) && WriteBytes(crc, 4);
+}
+
+bool WritePng(const string &filename, const Image &an_image,
+              size_t num_threads) {
+  PngWriter writer(num_threads);
+  if (!writer.Open(filename, an_image.num_rows(), an_image.num_columns())) {
+    return false;
+  }
+  for (size_t i = 0; i < an_image.num_rows(); ++i) {
+    if (!writer.WriteRow(an_image.row(i))) return false;
+  }
+  return writer.Close();
+}
 
 }  // namespace ComputerVisionProjects
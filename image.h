@@ -3,52 +3,279 @@
 #ifndef COMPUTER_VISION_IMAGE_H_
 #define COMPUTER_VISION_IMAGE_H_
 
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <string>
+#include <vector>
 
 namespace image{
 
-class Image {
+// Grayscale image stored row after row in one contiguous buffer aligned to
+// a cache line, num_columns pixels per row. Pixel is the type of a gray
+// level, uint8_t unless more than 256 levels are needed.
+template <typename Pixel = uint8_t>
+class BasicImage {
  public:
-  Image(): num_rows_{0}, num_columns_{0},
-	   num_gray_levels_{0}, pixels_{nullptr} {}
-  explicit Image(const Image &an_image);
-  explicit Image(Image &&an_image);
+  BasicImage(): num_rows_{0}, num_columns_{0},
+                num_gray_levels_{0}, pixels_{nullptr} {}
+  BasicImage(const BasicImage &an_image): BasicImage() { *this = an_image; }
+  // Takes the pixels of an_image, which is left empty.
+  BasicImage(BasicImage &&an_image) noexcept: BasicImage() {
+    swap(an_image);
+  }
 
-  ~Image();
-  Image& operator=(const Image& rhs);
-  Image& operator=(Image&& rhs);
+  ~BasicImage() { DeallocateSpace(); }
+  BasicImage& operator=(const BasicImage& rhs) {
+    if (this != &rhs) {
+      AllocateSpaceAndSetSize(rhs.num_rows_, rhs.num_columns_);
+      num_gray_levels_ = rhs.num_gray_levels_;
+      if (size() > 0) memcpy(pixels_, rhs.pixels_, size() * sizeof(Pixel));
+    }
+    return *this;
+  }
+  BasicImage& operator=(BasicImage&& rhs) noexcept {
+    if (this != &rhs) {
+      DeallocateSpace();
+      swap(rhs);
+    }
+    return *this;
+  }
+  void swap(BasicImage& other) noexcept {
+    std::swap(num_rows_, other.num_rows_);
+    std::swap(num_columns_, other.num_columns_);
+    std::swap(num_gray_levels_, other.num_gray_levels_);
+    std::swap(pixels_, other.pixels_);
+  }
 
   // Sets the size of the image to the given
   // height (num_rows) and columns (num_columns).
-  void AllocateSpaceAndSetSize(size_t num_rows, size_t num_columns);
+  // Pixels are left uninitialized.
+  void AllocateSpaceAndSetSize(size_t num_rows, size_t num_columns) {
+    if (num_rows * num_columns != size()) {
+      DeallocateSpace();
+      const size_t bytes = num_rows * num_columns * sizeof(Pixel);
+      // rounded up to whole cache lines, so the last row can be read in
+      // aligned blocks too.
+      void *buffer = nullptr;
+      if (bytes > 0 && posix_memalign(&buffer, kAlignment,
+                                      (bytes + kAlignment - 1) / kAlignment
+                                      * kAlignment) != 0) abort();
+      pixels_ = static_cast<Pixel *>(buffer);
+    }
+    num_rows_ = num_rows;
+    num_columns_ = num_columns;
+  }
   void SetNumberGrayLevels(unsigned short gray_levels) {
     num_gray_levels_ = gray_levels;
   }
-  void Fill(unsigned short value);
+  void Fill(Pixel value) { std::fill_n(pixels_, size(), value); }
   // Sets the pixel in the image at row i and column j
   // to a particular gray_level.
-  void SetPixel(size_t i, size_t j, unsigned short gray_level) {
+  void SetPixel(size_t i, size_t j, Pixel gray_level) {
     if (i >= num_rows_ || j >= num_columns_) abort();
-    pixels_[i][j] = gray_level;
+    pixels_[i * num_columns_ + j] = gray_level;
   }
 
   size_t num_rows() const { return num_rows_; }
   size_t num_columns() const { return num_columns_; }
   size_t num_gray_levels() const { return num_gray_levels_; }
+  // Returns num_rows * num_columns.
+  size_t size() const { return num_rows_ * num_columns_; }
+  bool empty() const { return size() == 0; }
 
-  int GetPixel(size_t i, size_t j) const {
+  Pixel GetPixel(size_t i, size_t j) const {
     if (i >= num_rows_ || j >= num_columns_) abort();
-    return pixels_[i][j];
+    return pixels_[i * num_columns_ + j];
+  }
+  // Returns the num_columns pixels of row i, for writing whole spans
+  // with one bounds check.
+  Pixel* row(size_t i) {
+    if (i >= num_rows_) abort();
+    return pixels_ + i * num_columns_;
   }
+  const Pixel* row(size_t i) const {
+    if (i >= num_rows_) abort();
+    return pixels_ + i * num_columns_;
+  }
+  // Returns the length pixels of row i starting at column j.
+  Pixel* span(size_t i, size_t j, size_t length) {
+    if (j > num_columns_ || length > num_columns_ - j) abort();
+    return row(i) + j;
+  }
+  // Returns every pixel, row after row.
+  Pixel* data() { return pixels_; }
+  const Pixel* data() const { return pixels_; }
 
  private:
-  void DeallocateSpace();
+  static const size_t kAlignment = 64;
+
+  void DeallocateSpace() {
+    free(pixels_);
+    pixels_ = nullptr;
+    num_rows_ = 0;
+    num_columns_ = 0;
+  }
+
   size_t num_rows_;
   size_t num_columns_;
   unsigned short num_gray_levels_;
-  int **pixels_;
+  Pixel *pixels_;
+};
+
+typedef BasicImage<uint8_t> Image;
+extern template class BasicImage<uint8_t>;
+
+// Writes an image file one row of fixed size at a time after its header,
+// so the whole image never has to be held in memory. Rows are buffered and
+// written in large blocks. The writers below differ in their header, how
+// pixels are packed into a row and, for PngWriter, how rows are encoded.
+class RasterWriter {
+ public:
+  RasterWriter(const RasterWriter&) = delete;
+  RasterWriter& operator=(const RasterWriter&) = delete;
+  virtual ~RasterWriter();
+
+  // Appends one row of row_bytes() bytes.
+  // Returns true if everything is OK, false otherwise.
+  bool WriteRow(const unsigned char *row);
+  // Flushes and closes the file.
+  // Returns false if fewer than num_rows rows were written or on I/O error.
+  bool Close();
+
+  size_t num_rows() const { return num_rows_; }
+  size_t row_bytes() const { return row_bytes_; }
+
+ protected:
+  // name prefixes error messages.
+  explicit RasterWriter(const char *name)
+      : name_{name}, output_{nullptr}, num_rows_{0}, row_bytes_{0},
+        rows_written_{0} {}
+
+  // Creates output_filename and writes the header bytes.
+  // Returns true if everything is OK, false otherwise.
+  bool Open(const std::string &output_filename, const std::string &header,
+            size_t num_rows, size_t row_bytes);
+  // Writes one row to the file as is.
+  // Returns true if everything is OK, false otherwise.
+  virtual bool EncodeRow(const unsigned char *row);
+  // Writes what follows the last row, called by Close. Nothing by default.
+  // Returns true if everything is OK, false otherwise.
+  virtual bool Finish() { return true; }
+  // Appends size bytes of data to the file.
+  // Returns true if everything is OK, false otherwise.
+  bool WriteBytes(const void *data, size_t size);
+  const char *name() const { return name_; }
+
+ private:
+  const char *name_;
+  FILE *output_;
+  size_t num_rows_;
+  size_t row_bytes_;
+  size_t rows_written_;
+};
+
+// Writes a pgm image one row at a time, one byte per pixel.
+class PgmWriter : public RasterWriter {
+ public:
+  PgmWriter(): RasterWriter("PgmWriter") {}
+
+  // Creates output_filename and writes the header.
+  // Returns true if everything is OK, false otherwise.
+  bool Open(const std::string &output_filename, size_t num_rows,
+            size_t num_columns, unsigned short gray_levels);
+
+  size_t num_columns() const { return row_bytes(); }
+};
+
+// Writes a 1 bit per pixel pbm (P4) image one row at a time. A row holds
+// 8 pixels per byte, the leftmost in the highest bit, 1 for black, and
+// its last byte is padded with zeros.
+class PbmWriter : public RasterWriter {
+ public:
+  PbmWriter(): RasterWriter("PbmWriter") {}
+
+  // Creates output_filename and writes the header.
+  // Returns true if everything is OK, false otherwise.
+  bool Open(const std::string &output_filename, size_t num_rows,
+            size_t num_columns);
+};
+
+// Writes a 4 bit palette bmp image one row at a time, top row first. A row
+// holds 2 pixels per byte, the leftmost in the high nibble, each the index
+// of its gray level in the palette, and is padded with zeros to a multiple
+// of 4 bytes, see BmpRowBytes.
+class BmpWriter : public RasterWriter {
+ public:
+  BmpWriter(): RasterWriter("BmpWriter") {}
+
+  // Creates output_filename and writes the header.
+  // palette holds up to 16 gray levels.
+  // Returns false if the file would pass 4GB, the bmp limit, or on error.
+  bool Open(const std::string &output_filename, size_t num_rows,
+            size_t num_columns, const std::vector<unsigned char> &palette);
 };
 
+// Writes an 8 bit grayscale png image one row at a time. Each row is
+// filtered with Up when it repeats the row above, which makes it all
+// zeros, and with Sub otherwise, which makes runs of a gray level zeros.
+// Filtered rows are gathered into blocks of about kBlockBytes, and every
+// num_threads blocks are deflated at once, one per thread, the way pigz
+// does: each block is primed with the 32KB before it and ends on a sync
+// flush, so the pieces join into one zlib stream whose Adler-32 is combined
+// from theirs. Memory is about 2*num_threads blocks whatever the size of
+// the image.
+class PngWriter : public RasterWriter {
+ public:
+  static const size_t kBlockBytes = 1 << 20;
+
+  // level is the zlib level, 1 fastest to 9 smallest. Filtered maze rows
+  // come out about 3 times smaller at 6 than at 1 for 3 times the time.
+  explicit PngWriter(size_t num_threads = 1, int level = 6)
+      : RasterWriter("PngWriter"), num_threads_{std::max<size_t>(1, num_threads)},
+        level_{level}, used_{0}, adler_{1}, started_{false} {}
+
+  // Creates output_filename and writes the signature and header.
+  // Returns true if everything is OK, false otherwise.
+  bool Open(const std::string &output_filename, size_t num_rows,
+            size_t num_columns);
+
+ protected:
+  bool EncodeRow(const unsigned char *row) override;
+  bool Finish() override;
+
+ private:
+  struct Block {
+    std::vector<unsigned char> raw; // filtered rows
+    std::vector<unsigned char> compressed;
+    uint32_t adler; // Adler-32 of raw
+    bool ok;
+  };
+
+  // Deflates the used_ blocks in parallel and writes them as IDAT chunks.
+  // last ends the zlib stream after them.
+  // Returns true if everything is OK, false otherwise.
+  bool WriteBlocks(bool last);
+  // Returns true if everything is OK, false otherwise.
+  bool WriteChunk(const char *type, const unsigned char *data, size_t size);
+
+  size_t num_threads_;
+  int level_;
+  std::vector<Block> blocks_;
+  size_t used_; // blocks_ holding rows, the last one still filling
+  std::vector<unsigned char> previous_; // the row before, unfiltered
+  std::vector<unsigned char> window_; // last 32KB of raw before blocks_
+  uint32_t adler_; // of every block written
+  bool started_; // zlib header written
+};
+
+// Returns the bytes of a row of a 4 bit bmp image num_columns wide.
+inline size_t BmpRowBytes(size_t num_columns) {
+  return ((num_columns + 7) / 8) * 4;
+}
+
 // Reads a pgm image from file input_filename.
 // an_image is the resulting image.
 // Returns true if  everyhing is OK, false otherwise.
@@ -58,6 +285,12 @@ bool ReadImage(const std::string &input_filename, Image *an_image);
 // Returns true if  everyhing is OK, false otherwise.
 bool WriteImage(const std::string &output_filename, const Image &an_image);
 
+// Writes image an_image into the png file output_filename, deflated on
+// num_threads threads, see PngWriter.
+// Returns true if everything is OK, false otherwise.
+bool WritePng(const std::string &output_filename, const Image &an_image,
+              size_t num_threads = 1);
+
 
 }  // namespace ComputerVisionProjects
 
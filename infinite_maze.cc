@@ -0,0 +1,159 @@
+#include <iostream>
+
+#include "infinite_maze.h"
+#include "maze_generator.h"
+using namespace std;
+
+class InfiniteMaze::WindowGenerator : public MazeGenerator {
+  public:
+    WindowGenerator(InfiniteMaze* maze, const int64_t& row, const int64_t& col)
+        : maze_(maze), row_(row), col_(col) {}
+    void Generate(Maze* window, const uint64_t& /*seed*/) override {
+      maze_->CopyWindow(row_, col_, window);
+    }
+    string name() const override { return "window"; }
+
+  private:
+    InfiniteMaze* maze_;
+    int64_t row_;
+    int64_t col_;
+};
+
+InfiniteMaze::InfiniteMaze(const size_t& tile_size, const uint64_t& seed,
+                           const size_t& cache_tiles)
+    : tile_size_(tile_size), seed_(seed), cache_tiles_(max((size_t)1, cache_tiles)),
+      tiles_generated_(0) {
+  if(tile_size_ == 0 || tile_size_ > 65535) {
+    cout << "Tile size must be between 1 and 65535, using 64." << endl;
+    tile_size_ = 64;
+  }
+}
+
+bool InfiniteMaze::HasRightWall(const int64_t& row, const int64_t& col) {
+  int64_t tile_row, tile_col;
+  size_t offset_row, offset_col;
+  SplitCoordinate(row, &tile_row, &offset_row);
+  SplitCoordinate(col, &tile_col, &offset_col);
+  return GetTile(tile_row, tile_col).HasRightWall(offset_row*tile_size_ + offset_col);
+}
+
+bool InfiniteMaze::HasBottomWall(const int64_t& row, const int64_t& col) {
+  int64_t tile_row, tile_col;
+  size_t offset_row, offset_col;
+  SplitCoordinate(row, &tile_row, &offset_row);
+  SplitCoordinate(col, &tile_col, &offset_col);
+  return GetTile(tile_row, tile_col).HasBottomWall(offset_row*tile_size_ + offset_col);
+}
+
+Maze InfiniteMaze::GetWindow(const int64_t& row, const int64_t& col,
+                             const size_t& rows, const size_t& cols) {
+  Maze window(rows, cols);
+  if(rows == 0 || cols == 0) {
+    return window;
+  }
+  // Maze::Generate rebuilds the window's set from the copied walls.
+  WindowGenerator generator(this, row, col);
+  window.Generate(&generator, seed_);
+  return window;
+}
+
+const WallStore& InfiniteMaze::GetTile(const int64_t& tile_row,
+                                       const int64_t& tile_col) {
+  TileKey key(tile_row, tile_col);
+  auto found = tile_index_.find(key);
+  if(found != tile_index_.end()) {
+    tiles_.splice(tiles_.begin(), tiles_, found->second);
+    return tiles_.front().second;
+  }
+  if(tiles_.size() == cache_tiles_) {
+    tile_index_.erase(tiles_.back().first);
+    tiles_.pop_back();
+  }
+  tiles_.emplace_front(key, GenerateTile(tile_row, tile_col));
+  tile_index_[key] = tiles_.begin();
+  ++tiles_generated_;
+  return tiles_.front().second;
+}
+
+void InfiniteMaze::CopyWindow(const int64_t& row, const int64_t& col,
+                              Maze* window) {
+  const size_t rows = window->num_rows();
+  const size_t cols = window->num_columns();
+  int64_t tile_row, tile_col;
+  size_t offset_row, offset_col, span_rows, span_cols, local, cell;
+  // Tile by tile, so every tile is looked up once whatever the cache size.
+  for(size_t r = 0; r < rows; r += span_rows) {
+    SplitCoordinate(row + (int64_t)r, &tile_row, &offset_row);
+    span_rows = min(tile_size_ - offset_row, rows - r);
+    for(size_t c = 0; c < cols; c += span_cols) {
+      SplitCoordinate(col + (int64_t)c, &tile_col, &offset_col);
+      span_cols = min(tile_size_ - offset_col, cols - c);
+      const WallStore& tile = GetTile(tile_row, tile_col);
+      for(size_t i = 0; i < span_rows; ++i) {
+        local = (offset_row + i)*tile_size_ + offset_col;
+        cell = (r + i)*cols + c;
+        for(size_t j = 0; j < span_cols; ++j) {
+          if(!tile.HasRightWall(local + j) && c + j != cols - 1) {
+            window->OpenWall(cell + j, 0);
+          }
+          if(!tile.HasBottomWall(local + j) && r + i != rows - 1) {
+            window->OpenWall(cell + j, 1);
+          }
+        }
+      }
+    }
+  }
+}
+
+WallStore InfiniteMaze::GenerateTile(const int64_t& tile_row,
+                                     const int64_t& tile_col) const {
+  Maze tile(tile_size_, tile_size_);
+  tile.Generate(1, TileHash(tile_row, tile_col, 0));
+  WallStore walls = tile.walls();
+  if(LinksRight(tile_row, tile_col)) {
+    CounterRng gen(TileHash(tile_row, tile_col, 1));
+    walls.Break(gen.Below(tile_size_)*tile_size_ + tile_size_ - 1, 0);
+  }
+  if(LinksDown(tile_row, tile_col)) {
+    CounterRng gen(TileHash(tile_row, tile_col, 2));
+    walls.Break((tile_size_ - 1)*tile_size_ + gen.Below(tile_size_), 1);
+  }
+  return walls;
+}
+
+uint64_t InfiniteMaze::TileHash(const int64_t& tile_row, const int64_t& tile_col,
+                                const uint64_t& kind) const {
+  return DeriveSeed(DeriveSeed(DeriveSeed(seed_, (uint64_t)tile_row),
+                               (uint64_t)tile_col), kind);
+}
+
+bool InfiniteMaze::LinksRight(const int64_t& tile_row, const int64_t& tile_col) const {
+  // either this tile steps right toward the origin or its right neighbor
+  // steps left toward it.
+  return (tile_col < 0 && ParentIsHorizontal(tile_row, tile_col))
+         || (tile_col + 1 > 0 && ParentIsHorizontal(tile_row, tile_col + 1));
+}
+
+bool InfiniteMaze::LinksDown(const int64_t& tile_row, const int64_t& tile_col) const {
+  return (tile_row < 0 && !ParentIsHorizontal(tile_row, tile_col))
+         || (tile_row + 1 > 0 && !ParentIsHorizontal(tile_row + 1, tile_col));
+}
+
+bool InfiniteMaze::ParentIsHorizontal(const int64_t& tile_row,
+                                      const int64_t& tile_col) const {
+  if(tile_col == 0) {
+    return false;
+  }
+  if(tile_row == 0) {
+    return true;
+  }
+  return CounterRng(TileHash(tile_row, tile_col, 3)).Coin();
+}
+
+void InfiniteMaze::SplitCoordinate(const int64_t& coordinate, int64_t* tile,
+                                   size_t* offset) const {
+  const int64_t side = (int64_t)tile_size_;
+  // rounds toward negative infinity so offsets are never negative.
+  *tile = coordinate >= 0 ? coordinate / side : -((-(coordinate + 1)) / side) - 1;
+  *offset = (size_t)(coordinate - *tile * side);
+}
@@ -0,0 +1,93 @@
+// Created by Wei Shi
+// Unbounded maze generated on demand, one tile at a time.
+#ifndef INFINITE_MAZE_H
+#define INFINITE_MAZE_H
+
+#include <list>
+#include <unordered_map>
+#include "maze.h"
+
+using namespace std;
+
+/**
+* INFINITE MAZE:
+*   1. The plane of cells is cut into tile_size*tile_size tiles addressed by
+*      signed tile coordinates. Every tile is an independent Kruskal maze
+*      whose seed is derived from the maze seed and the tile's coordinates.
+*   2. Every tile except the one at (0,0) links to exactly one neighboring
+*      tile one step closer to the origin, choosing the horizontal or the
+*      vertical step by hash when both exist. Links therefore form a tree
+*      over the tiles.
+*   3. Each link opens one wall on the shared tile border at a hashed
+*      position, so both tiles agree on the seam without seeing each other.
+*
+*   The whole plane is a single perfect maze and any cell's walls depend only
+*   on the seed, tile_size and that cell's tile. Recently used tiles are kept
+*   in an LRU cache.
+*/
+class InfiniteMaze {
+  public:
+    // @param tile_size is the side of a tile in cells, 1 to 65535.
+    // @param seed determines the maze together with tile_size.
+    // @param cache_tiles is the number of tiles kept in the cache.
+    explicit InfiniteMaze(const size_t& tile_size,
+                          const uint64_t& seed = RandomSeed(),
+                          const size_t& cache_tiles = 64);
+
+    bool HasRightWall(const int64_t& row, const int64_t& col);
+    bool HasBottomWall(const int64_t& row, const int64_t& col);
+    // Copies a rectangular window of the maze into a Maze, generating only
+    // the tiles it overlaps. Walls on the window's outer border are closed,
+    // so get_image and Solve work on it unchanged. Cells that are only
+    // connected through cells outside the window are not connected in it.
+    // @param (row, col) is the top left cell of the window.
+    // @param (rows, cols) are the dimensions of the window in cells.
+    Maze GetWindow(const int64_t& row, const int64_t& col,
+                   const size_t& rows, const size_t& cols);
+
+    size_t tile_size() const { return tile_size_; }
+    uint64_t seed() const { return seed_; }
+    // @return number of tiles generated since construction, cache misses.
+    size_t tiles_generated() const { return tiles_generated_; }
+
+  private:
+    // Copies the window's walls when Maze::Generate asks for them.
+    class WindowGenerator;
+    typedef pair<int64_t, int64_t> TileKey; // (tile row, tile col)
+    struct TileKeyHash {
+      size_t operator()(const TileKey& key) const {
+        return key.first * 0x9e3779b97f4a7c15ULL ^ key.second;
+      }
+    };
+    typedef list<pair<TileKey, WallStore>> TileList;
+
+    // @return walls of the tile, from the cache or freshly generated.
+    const WallStore& GetTile(const int64_t& tile_row, const int64_t& tile_col);
+    // Opens the walls of window that are open in the maze and not on the
+    // window's outer border.
+    // @param (row, col) is the cell of the maze at the window's top left.
+    void CopyWindow(const int64_t& row, const int64_t& col, Maze* window);
+    // Generates the tile's maze and opens its right and bottom seams.
+    WallStore GenerateTile(const int64_t& tile_row, const int64_t& tile_col) const;
+    // @return seed for a value of kind at a tile, see GenerateTile.
+    uint64_t TileHash(const int64_t& tile_row, const int64_t& tile_col,
+                      const uint64_t& kind) const;
+    // @return true if the tile links to the tile to its right.
+    bool LinksRight(const int64_t& tile_row, const int64_t& tile_col) const;
+    // @return true if the tile links to the tile below it.
+    bool LinksDown(const int64_t& tile_row, const int64_t& tile_col) const;
+    // @return true if the tile's link toward the origin is horizontal.
+    bool ParentIsHorizontal(const int64_t& tile_row, const int64_t& tile_col) const;
+    // Splits a cell coordinate into its tile and the offset in that tile.
+    void SplitCoordinate(const int64_t& coordinate, int64_t* tile,
+                         size_t* offset) const;
+
+    size_t tile_size_;
+    uint64_t seed_;
+    size_t cache_tiles_;
+    size_t tiles_generated_;
+    TileList tiles_; // most recently used first
+    unordered_map<TileKey, TileList::iterator, TileKeyHash> tile_index_;
+};
+
+#endif
@@ -1,45 +1,100 @@
+#include <cstring>
+#include <fstream>
 #include <iostream>
-#include <set>
-#include <unordered_map>
-#include <queue>
+#include <sstream>
+#include <thread>
 
 #include "maze.h"
+#include "maze_generator.h"
+#include "maze_render.h"
+#include "maze_solver.h"
+#include "streaming_maze.h"
 using namespace std;
 
 Maze::Maze(const size_t& rows, const size_t& cols) {
-  cells_ = vector<Cell>(rows*cols, Cell());
+  cells_ = WallStore(rows*cols);
   num_columns_ = cols;
   num_rows_ = rows;
-  set_ = DisjSets(rows*cols);
 }
 
 Maze::Maze(size_t&& rows, size_t&& cols) {
-  cells_ = vector<Cell>(std::move(rows)*std::move(cols), Cell());
+  cells_ = WallStore(rows*cols);
   num_columns_= std::move(cols);
   num_rows_ = std::move(rows);
-  set_ = DisjSets(std::move(rows)*std::move(cols));
 }
 
-Maze& Maze::operator=(const Maze& rhs) {
-  set_ = rhs.set_;
-  cells_ = rhs.cells_;
-  walls_ = rhs.walls_;
-  num_columns_ = rhs.num_columns_;
-  num_rows_ = rhs.num_rows_;
-  return *this;
+void Maze::Generate(const size_t& num_threads, const uint64_t& seed) {
+  if(cells_.empty()) {
+    cout << "Maze is empty. Please initialize its dimensions." << endl;
+    return;
+  }
+  cells_.Reset();
+  FeistelPermutation permutation(2*cells_.size(), seed);
+  if(num_threads > 1) {
+    set_ = DisjSets();
+    BreakWallsConcurrent(permutation, num_threads);
+  } else {
+    // only the serial path unions through set_.
+    set_ = DisjSets(cells_.size());
+    BreakWalls(permutation);
+  }
 }
 
-void Maze::Generate() {
+void Maze::Generate(MazeGenerator* generator, const uint64_t& seed) {
   if(cells_.empty()) {
     cout << "Maze is empty. Please initialize its dimensions." << endl;
     return;
   }
-  InitializeWalls();
-  vector<size_t> wall_index_samples = SampleRandomIndex(walls_.size());
+  cells_.Reset();
+  set_ = DisjSets();
+  generator->Generate(this, seed);
+}
 
-  for(size_t i = 0; i < wall_index_samples.size(); ++i) {
-    BreakWalls(wall_index_samples);
+void Maze::Braid(const double& fraction, const uint64_t& seed) {
+  const size_t columns = num_columns_;
+  CounterRng gen(seed);
+  // (cell owning the wall, wall) of each closed wall around a dead end.
+  pair<size_t, unsigned int> closed[4];
+  size_t neighbors[4];
+  for(size_t cell = 0; cell < cells_.size(); ++cell) {
+    // 53 random bits make a uniform double in [0, 1).
+    if(CountOpenWalls(cell) != 1 || (gen.At(cell) >> 11) / 9007199254740992.0 >= fraction) {
+      continue;
+    }
+    unsigned int count = 0;
+    if(cell % columns != 0 && cells_.HasRightWall(cell-1)) {
+      neighbors[count] = cell-1;
+      closed[count++] = pair<size_t, unsigned int>(cell-1, 0);
+    }
+    if(cell >= columns && cells_.HasBottomWall(cell-columns)) {
+      neighbors[count] = cell-columns;
+      closed[count++] = pair<size_t, unsigned int>(cell-columns, 1);
+    }
+    if(cell % columns != columns - 1 && cells_.HasRightWall(cell)) {
+      neighbors[count] = cell+1;
+      closed[count++] = pair<size_t, unsigned int>(cell, 0);
+    }
+    if(cell / columns != num_rows_ - 1 && cells_.HasBottomWall(cell)) {
+      neighbors[count] = cell+columns;
+      closed[count++] = pair<size_t, unsigned int>(cell, 1);
+    }
+    if(count == 0) {
+      continue;
+    }
+    // joining two dead ends removes both with one wall.
+    unsigned int dead_ends = 0;
+    for(unsigned int k = 0; k < count; ++k) {
+      if(CountOpenWalls(neighbors[k]) == 1) {
+        swap(closed[dead_ends], closed[k]);
+        swap(neighbors[dead_ends++], neighbors[k]);
+      }
+    }
+    CounterRng pick(DeriveSeed(seed, cell));
+    const unsigned int k = pick.Below(dead_ends > 0 ? dead_ends : count);
+    cells_.Break(closed[k].first, closed[k].second);
   }
+  // set_ no longer matches the walls; PrintSet rebuilds it.
+  set_ = DisjSets();
 }
 
 void Maze::PrintCells() const {
@@ -47,193 +102,332 @@ void Maze::PrintCells() const {
     if(i % num_columns_ == 0)
       cout << endl;
     cout << '(';
-    cells_[i].Print();
+    cells_.Print(i);
     cout << ')';
   }
   cout << endl;
 }
 
 void Maze::PrintWalls() const {
-  for(size_t i = 0; i < walls_.size(); ++i) {
-    if(i % num_columns_ == 0)
+  for(size_t id = 0; id < 2*cells_.size(); ++id) {
+    if(id % (2*num_columns_) == 0)
       cout << endl;
-    cout << '(' << walls_[i].first << ", " << walls_[i].second << ')';
+    if(IsInteriorWall(id))
+      cout << '(' << id/2 << ", " << id%2 << ')';
   }
   cout << endl;
 }
 
 void Maze::PrintSet() const {
-  set_.Print();
+  if(set_.Size() == cells_.size()) {
+    set_.Print();
+  } else {
+    SetFromWalls().Print();
+  }
 }
 
-Image* Maze::get_image(const size_t& scale) {
-  Image* maze = new Image();
-  size_t unit_row_size = (2*num_rows_)+1;
-  size_t unit_col_size = (2*num_columns_)+1;
-  maze->AllocateSpaceAndSetSize(scale*unit_row_size, scale*unit_col_size);
-  maze->SetNumberGrayLevels(255);
-  maze->Fill(130);
-  SetScaledPixel(0, scale, scale, maze, 255); // create starting point
-  SetScaledPixel( maze->num_rows()-scale, maze->num_columns()-(2*scale),
-                  scale, maze, 255); // create ending point
-
-  for(size_t i = scale; i < maze->num_rows(); i+=2*scale){
-    for(size_t j = scale; j < maze->num_columns(); j+=2*scale) {
-      SetScaledPixel(i,j,scale,maze,255);
-    }
+Image Maze::get_image(const size_t& scale) const {
+  Image maze;
+  ScanlineRenderer renderer(*this, scale);
+  maze.AllocateSpaceAndSetSize(renderer.height(), renderer.width());
+  maze.SetNumberGrayLevels(255);
+  if(maze.empty()) {
+    return maze;
   }
 
-  size_t row, col;
-  vector<bool> wall_array;
-  for(size_t i = 0; i < cells_.size(); ++i) {
-    wall_array = cells_[i].get_walls();
-    row = i/num_columns_; // row index from cells_ vector
-    col = i%num_columns_; // column index from cells_ vector
-    for(size_t k = 0; k < cells_[i].get_wall_count(); ++k) {
-      if(!wall_array[k]) {
-        BreakWallImage(k, row, col, maze, scale);
-      }
+  // the first image row of a unit row is rendered in place and the others
+  // are copies of it.
+  for(size_t unit_row = 0; unit_row < renderer.unit_height(); ++unit_row) {
+    unsigned char* scanline = maze.row(unit_row*scale);
+    renderer.Render(unit_row, scanline);
+    for(size_t i = unit_row*scale + 1; i < (unit_row+1)*scale; ++i) {
+      memcpy(maze.row(i), scanline, renderer.width());
     }
   }
-
   return maze;
 }
 
-Image* Maze::get_solved_image(const size_t& start_row, const size_t& start_col,
+Image Maze::get_solved_image(const size_t& start_row, const size_t& start_col,
                               const size_t& end_row, const size_t& end_col,
                               const size_t& scale){
 
     size_t start_index = (num_columns_*start_row) + start_col;
     size_t end_index = (num_columns_*end_row) + end_col;
 
-    Image* solved_maze = get_solved_image(start_index, end_index, scale);
+    Image solved_maze = get_solved_image(start_index, end_index, scale);
+    if(solved_maze.empty()) {
+      return solved_maze;
+    }
 
     size_t start_row_index = (2*start_row)+1;
     size_t start_col_index = (2*start_col)+1;
     size_t end_row_index = (2*end_row)+1;
     size_t end_col_index = (2*end_col)+1;
 
-    SetScaledPixel(scale*start_row_index, scale*start_col_index, scale, solved_maze, 90); // create starting point
-    SetScaledPixel(scale*end_row_index, scale*end_col_index, scale, solved_maze, 0); // create ending point
+    SetScaledPixel(scale*start_row_index, scale*start_col_index, scale, &solved_maze, kStartShade); // create starting point
+    SetScaledPixel(scale*end_row_index, scale*end_col_index, scale, &solved_maze, kEndShade); // create ending point
 
     return solved_maze;
 }
 
-Image* Maze::get_solved_image(const size_t& start, const size_t& end,
-                              const size_t& scale) {
+Image Maze::get_solved_image(const size_t& start, const size_t& end,
+                             const size_t& scale) {
   if(end > cells_.size()) {
     cout << "ERROR: Maze end point out of bounds." << endl;
-    return nullptr;
-  }
-
-  Image* solved_maze = get_image(scale);
-  SetScaledPixel(0, scale, scale, solved_maze, 255); // create starting point
-  SetScaledPixel( solved_maze->num_rows()-scale, solved_maze->num_columns()-(2*scale),
-                  scale, solved_maze, 255); // create ending point
-
-  unsigned int path_shade = 200;
-
-  forward_list<size_t> path = Solve(start, end);
-  forward_list<size_t>::const_iterator cit = path.begin();
-  ++cit;
-  size_t image_unit_row; // unit row start at 1 due to boundary padding
-  size_t image_unit_col; // unit col start at 1 due to boundary padding
-  for(const auto& index: path) {
-    image_unit_row = (2*(index/num_columns_)) + 1;
-    image_unit_col = (2*(index%num_columns_)) + 1;
-    SetScaledPixel(scale*image_unit_row, scale*image_unit_col, scale, solved_maze, path_shade);
-
-    if(cit != path.end()) {
-      if((index - *cit) == 1) { // moving left
-        SetScaledPixel(scale*image_unit_row, scale*(image_unit_col-1), scale, solved_maze, path_shade);
-      } else if ((index - *cit) == num_columns_) { // moving up
-        SetScaledPixel(scale*(image_unit_row-1), scale*image_unit_col, scale, solved_maze, path_shade);
-      } else if ((int)(index - *cit) == -1) { // moving right
-        SetScaledPixel(scale*image_unit_row, scale*(image_unit_col+1), scale, solved_maze, path_shade);
-      } else if ((int)(index - *cit) == (int)(-1*num_columns_)) { // moving down
-        SetScaledPixel(scale*(image_unit_row+1), scale*image_unit_col, scale, solved_maze, path_shade);
-      }
-    }
-    if(cit != path.end()) {
-      ++cit;
-    }
+    return Image();
   }
 
+  PackedPath path;
+  Solve(start, end, &path);
+  return get_solved_image(path, scale);
+}
+
+Image Maze::get_solved_image(const PackedPath& path, const size_t& scale) {
+  Image solved_maze = get_image(scale);
+  PathOverlay overlay(*this, scale, &solved_maze);
+  overlay.DrawPath(path, kPathShade);
   return solved_maze;
 }
 
-Image* Maze::get_grid(const size_t& rows, const size_t& columns,
-                      const size_t& scale) {
-  Image* maze = new Image();
+Image Maze::get_grid(const size_t& rows, const size_t& columns,
+                     const size_t& scale) {
+  Image maze;
   size_t unit_row_size = (2*num_rows_)+1;
   size_t unit_col_size = (2*num_columns_)+1;
-  maze->AllocateSpaceAndSetSize(scale*unit_row_size, scale*unit_col_size);
-  maze->SetNumberGrayLevels(255);
-  maze->Fill(130);
+  maze.AllocateSpaceAndSetSize(scale*unit_row_size, scale*unit_col_size);
+  maze.SetNumberGrayLevels(255);
+  maze.Fill(130);
 
-  for(size_t i = scale; i < maze->num_rows(); i+=2*scale){
-    for(size_t j = scale; j < maze->num_columns(); j+=2*scale) {
-      SetScaledPixel(i,j,scale,maze,255);
+  for(size_t i = scale; i < maze.num_rows(); i+=2*scale){
+    for(size_t j = scale; j < maze.num_columns(); j+=2*scale) {
+      SetScaledPixel(i,j,scale,&maze,255);
     }
   }
 
   return maze;
 }
 
-forward_list<size_t> Maze::Solve(const size_t& start, const size_t& end) const {
-  forward_list<size_t> result;
-  unordered_map<size_t, size_t> cell_to_previous;
-  set<size_t> visited;
+Image Maze::get_heatmap(const vector<uint32_t>& distance, const size_t& scale) {
+  Image heatmap;
+  heatmap.AllocateSpaceAndSetSize(scale*((2*num_rows_)+1),
+                                  scale*((2*num_columns_)+1));
+  heatmap.SetNumberGrayLevels(255);
+  heatmap.Fill(0);
+
+  uint32_t farthest = 0;
+  for(const auto& d: distance) {
+    if(d != kUnreachable) {
+      farthest = max(farthest, d);
+    }
+  }
+  auto shade = [&](const uint32_t& d) -> unsigned int {
+    if(d == kUnreachable) {
+      return 20;
+    }
+    return farthest == 0 ? 255 : 255 - (unsigned int)((uint64_t)215*d / farthest);
+  };
 
-  cell_to_previous[start] = start;
-  queue<size_t> cells_to_visit;
-  cells_to_visit.push(start);
-  size_t current_cell;
-  size_t left_cell, top_cell;
+  size_t image_unit_row, image_unit_col;
+  for(size_t i = 0; i < cells_.size(); ++i) {
+    image_unit_row = (2*(i/num_columns_)) + 1;
+    image_unit_col = (2*(i%num_columns_)) + 1;
+    SetScaledPixel(scale*image_unit_row, scale*image_unit_col, scale, &heatmap,
+                   shade(distance[i]));
+    // an open wall takes the shade of the closer of its two cells.
+    if(!cells_.HasRightWall(i)) {
+      SetScaledPixel(scale*image_unit_row, scale*(image_unit_col+1), scale,
+                     &heatmap, shade(min(distance[i], distance[i+1])));
+    }
+    if(!cells_.HasBottomWall(i)) {
+      SetScaledPixel(scale*(image_unit_row+1), scale*image_unit_col, scale,
+                     &heatmap, shade(min(distance[i], distance[i+num_columns_])));
+    }
+  }
+  return heatmap;
+}
 
-  while(!cells_to_visit.empty()) {
-    current_cell = cells_to_visit.front();
-    visited.insert(current_cell);
-    cells_to_visit.pop();
+forward_list<size_t> Maze::Solve(const size_t& start, const size_t& end) const {
+  BfsSolver solver;
+  vector<size_t> path;
+  solver.Solve(*this, start, end, &path);
+  return forward_list<size_t>(path.begin(), path.end());
+}
 
-    if(current_cell == end) {
-      while(current_cell != start) {
-        result.push_front(current_cell);
-        current_cell = cell_to_previous[current_cell];
+bool Maze::Solve(const size_t& start, const size_t& end, PackedPath* path) const {
+  BfsSolver solver;
+  return solver.SolvePacked(*this, start, end, path);
+}
+
+bool Maze::SolveBatch(const vector<pair<size_t, size_t>>& queries,
+                      const size_t& num_threads, vector<size_t>* lengths,
+                      vector<vector<size_t>>* paths,
+                      const string& solver) const {
+  if(!MakeSolver(solver)) {
+    cout << "ERROR: unknown solver " << solver << ". Use one of:";
+    for(const auto& name: SolverNames()) {
+      cout << ' ' << name;
+    }
+    cout << '.' << endl;
+    return false;
+  }
+  if(lengths) {
+    lengths->assign(queries.size(), SIZE_MAX);
+  }
+  if(paths) {
+    paths->assign(queries.size(), vector<size_t>());
+  }
+  // Queries are handed out one at a time, so a few long ones don't leave
+  // the other threads idle.
+  atomic<size_t> next_query(0);
+  auto worker = [&]() {
+    unique_ptr<MazeSolver> search = MakeSolver(solver);
+    vector<size_t> path;
+    size_t query;
+    while((query = next_query.fetch_add(1)) < queries.size()) {
+      if(!search->Solve(*this, queries[query].first, queries[query].second, &path)) {
+        continue;
+      }
+      if(lengths) {
+        (*lengths)[query] = path.size() - 1;
+      }
+      if(paths) {
+        (*paths)[query] = path;
       }
-      result.push_front(current_cell);
-      return result;
     }
+  };
+  vector<thread> threads;
+  for(size_t i = 1; i < num_threads && i < queries.size(); ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for(auto& t: threads) {
+    t.join();
+  }
+  return true;
+}
 
-    left_cell = current_cell-1;
-    top_cell = current_cell-num_columns_;
-
-    // check if current cell is connected to the cell to its left.
-    if(visited.find(left_cell) == visited.end() && (current_cell % num_columns_) != 0 && !cells_[left_cell].HasRightWall()) {
-      cells_to_visit.push(left_cell);
-      cell_to_previous[left_cell] = current_cell;
+MazeStats Maze::Analyze(const size_t& start, const size_t& end) const {
+  MazeStats stats;
+  const size_t columns = num_columns_;
+  size_t neighbors[4];
+  // Open neighbors of cell, the same order every time so a walk can tell
+  // which way it came from.
+  auto open_neighbors = [&](const size_t& cell) {
+    unsigned int count = 0;
+    if(cell % columns != 0 && !cells_.HasRightWall(cell-1)) {
+      neighbors[count++] = cell-1;
     }
-    // check if current cell is connected to the cell to its top.
-    if(visited.find(top_cell) == visited.end() && (current_cell / num_columns_) != 0 && !cells_[top_cell].HasBottomWall()) {
-      cells_to_visit.push(top_cell);
-      cell_to_previous[top_cell] = current_cell;
+    if(cell >= columns && !cells_.HasBottomWall(cell-columns)) {
+      neighbors[count++] = cell-columns;
     }
-    // check if current cell is connected to the cell to its right.
-    if(visited.find(current_cell+1) == visited.end() && !cells_[current_cell].HasRightWall()){
-      cells_to_visit.push(current_cell+1);
-      cell_to_previous[current_cell+1] = current_cell;
+    if(!cells_.HasRightWall(cell)) {
+      neighbors[count++] = cell+1;
     }
-    // check if current cell is connected to the cell to its bottom.
-    if(visited.find(current_cell+num_columns_) == visited.end() && !cells_[current_cell].HasBottomWall()){
-      cells_to_visit.push(current_cell+num_columns_);
-      cell_to_previous[current_cell+num_columns_] = current_cell;
+    if(!cells_.HasBottomWall(cell)) {
+      neighbors[count++] = cell+columns;
     }
+    return count;
+  };
+
+  // Every corridor is walked from both of its ends and counted from the
+  // lower one, so the pass needs no memory of its own.
+  size_t first[4];
+  for(size_t cell = 0; cell < cells_.size(); ++cell) {
+    const unsigned int degree = CountOpenWalls(cell);
+    if(degree == 2) {
+      continue;
+    }
+    stats.dead_ends += degree == 1;
+    stats.junctions += degree >= 3;
+    copy(neighbors, neighbors + open_neighbors(cell), first);
+    for(unsigned int k = 0; k < degree; ++k) {
+      size_t previous = cell;
+      size_t current = first[k];
+      size_t moves = 1;
+      while(CountOpenWalls(current) == 2) {
+        open_neighbors(current);
+        const size_t next = neighbors[0] == previous ? neighbors[1] : neighbors[0];
+        previous = current;
+        current = next;
+        ++moves;
+      }
+      // a loop back to cell is seen from both ends too, keep one.
+      if(current > cell || (current == cell && first[k] < previous)) {
+        ++stats.corridors;
+        size_t bucket = 0;
+        while(moves >> (bucket + 1)) {
+          ++bucket;
+        }
+        if(stats.corridor_histogram.size() <= bucket) {
+          stats.corridor_histogram.resize(bucket + 1, 0);
+        }
+        ++stats.corridor_histogram[bucket];
+      }
+    }
+  }
+
+  if(start >= cells_.size() || end >= cells_.size()) {
+    cout << "ERROR: Maze start or end point out of bounds." << endl;
+    return stats;
   }
+  vector<size_t> queue(cells_.size());
+  vector<uint64_t> visited((cells_.size() + 63) / 64);
+  size_t ignored;
+  stats.diameter_start = Sweep(start, end, &queue, &visited, &stats.diameter,
+                               &stats.solution_length);
+  stats.diameter_end = Sweep(stats.diameter_start, stats.diameter_start, &queue,
+                             &visited, &stats.diameter, &ignored);
+  return stats;
+}
 
-  return result;
+size_t Maze::Sweep(const size_t& source, const size_t& end, vector<size_t>* queue,
+                   vector<uint64_t>* visited, size_t* distance,
+                   size_t* end_distance) const {
+  const size_t columns = num_columns_;
+  fill(visited->begin(), visited->end(), 0);
+  auto visit = [&](const size_t& cell, size_t* tail) {
+    if(((*visited)[cell >> 6] >> (cell & 63)) & 1) {
+      return;
+    }
+    (*visited)[cell >> 6] |= 1ULL << (cell & 63);
+    (*queue)[(*tail)++] = cell;
+  };
+  size_t tail = 0;
+  size_t level_begin = 0;
+  size_t level_end;
+  size_t cell;
+  visit(source, &tail);
+  *distance = 0;
+  *end_distance = SIZE_MAX;
+  while(true) {
+    level_end = tail;
+    for(size_t head = level_begin; head < level_end; ++head) {
+      cell = (*queue)[head];
+      if(cell == end) {
+        *end_distance = *distance;
+      }
+      if(cell % columns != 0 && !cells_.HasRightWall(cell-1)) {
+        visit(cell-1, &tail);
+      }
+      if(cell >= columns && !cells_.HasBottomWall(cell-columns)) {
+        visit(cell-columns, &tail);
+      }
+      if(!cells_.HasRightWall(cell)) {
+        visit(cell+1, &tail);
+      }
+      if(!cells_.HasBottomWall(cell)) {
+        visit(cell+columns, &tail);
+      }
+    }
+    if(tail == level_end) {
+      return (*queue)[level_begin];
+    }
+    level_begin = level_end;
+    ++*distance;
+  }
 }
 
-size_t Maze::GetNeighborIndex(const size_t& current, const unsigned int& wall) {
+size_t Maze::GetNeighborIndex(const size_t& current, const unsigned int& wall) const {
   size_t neighbor_cell_index;
   switch(wall) {
     case 0: // right
@@ -252,45 +446,268 @@ bool Maze::IsInSameSet(const size_t& current, const size_t& neighbor) {
 
 void Maze::BreakWall( const size_t& cell_index, const size_t& neighbor,
                       const unsigned int& wall) {
-  cells_[cell_index].Break(wall);
+  cells_.Break(cell_index, wall);
   set_.UnionSets(set_.Find(cell_index), set_.Find(neighbor));
 }
 
-void Maze::BreakWalls(const vector<size_t>& random_indices) {
+bool Maze::IsInteriorWall(const size_t& wall_id) const {
+  const size_t cell = wall_id / 2;
+  if(wall_id % 2 == 0) {
+    return cell % num_columns_ != num_columns_ - 1;
+  }
+  return cell / num_columns_ != num_rows_ - 1;
+}
+
+void Maze::BreakWalls(const FeistelPermutation& permutation) {
   size_t current_cell;
   unsigned int current_wall;
   size_t neighbor;
-
-  for(size_t i = 0; i < random_indices.size(); ++i) {
-    current_cell = walls_[random_indices[i]].first;
-    current_wall = walls_[random_indices[i]].second;
+  size_t wall_id;
+  // a spanning tree of n cells has exactly n-1 open walls, so every wall left
+  // in the pool after that many unions would join cells already in one set.
+  size_t unions_left = cells_.size() - 1;
+
+  for(size_t i = 0; i < permutation.size() && unions_left > 0; ++i) {
+    wall_id = permutation(i);
+    if(!IsInteriorWall(wall_id)) {
+      continue;
+    }
+    current_cell = wall_id / 2;
+    current_wall = wall_id % 2;
     neighbor = GetNeighborIndex(current_cell, current_wall);
     if(!IsInSameSet(current_cell, neighbor)) {
       BreakWall(current_cell, neighbor, current_wall);
+      --unions_left;
+    }
+  }
+}
+
+void Maze::BreakWallsConcurrent(const FeistelPermutation& permutation,
+                                const size_t& num_threads) {
+  const size_t chunk_size = 1 << 12;
+  const size_t max_batch_size = 1 << 20;
+  ConcurrentDisjSets concurrent_set(cells_.size());
+  const size_t filtered = 2*cells_.size() - 1; // bottom wall of the last cell
+  size_t unions_left = cells_.size() - 1;
+  // Two batches are in flight: one being filtered into candidate[filling],
+  // and the one before it, whose walls the calling thread unions. Each slot
+  // holds the wall id of its position, or filtered when the wall was dropped.
+  vector<size_t> candidate[2];
+  unsigned int filling = 0;
+  // Written only by the barrier's completion, read by every thread after it.
+  size_t batch_size = min((size_t)1 << 16, (size_t)permutation.size());
+  size_t filter_begin = 0, filter_end = batch_size;
+  size_t union_begin = 0, union_end = 0;
+  bool done = false;
+  atomic<size_t> next_chunk(0);
+  atomic<size_t> kept(0);
+  SpinBarrier barrier(num_threads);
+  candidate[filling].resize(batch_size);
+
+  // Finds never miss a union made before they start, and unions only merge
+  // sets, so a dropped wall would also be rejected by the union pass.
+  auto filter = [&]() {
+    vector<size_t>& out = candidate[filling];
+    size_t first, wall_id, count;
+    while((first = filter_begin + next_chunk.fetch_add(chunk_size, memory_order_relaxed))
+          < filter_end) {
+      const size_t last = min(first + chunk_size, filter_end);
+      count = 0;
+      for(size_t i = first; i < last; ++i) {
+        wall_id = permutation(i);
+        if(IsInteriorWall(wall_id)
+           && concurrent_set.Find(wall_id / 2)
+              != concurrent_set.Find(GetNeighborIndex(wall_id / 2, wall_id % 2))) {
+          out[i-filter_begin] = wall_id;
+          ++count;
+        } else {
+          out[i-filter_begin] = filtered;
+        }
+      }
+      kept.fetch_add(count, memory_order_relaxed);
+    }
+  };
+  auto unite = [&]() {
+    const vector<size_t>& in = candidate[1-filling];
+    size_t current_cell, neighbor;
+    for(size_t i = union_begin; i < union_end && unions_left > 0; ++i) {
+      if(in[i-union_begin] == filtered) {
+        continue;
+      }
+      current_cell = in[i-union_begin] / 2;
+      neighbor = GetNeighborIndex(current_cell, in[i-union_begin] % 2);
+      if(concurrent_set.UnionSets(current_cell, neighbor)) {
+        cells_.Break(current_cell, in[i-union_begin] % 2);
+        --unions_left;
+      }
+    }
+  };
+  // Hands the filtered batch to the union pass and picks the next one.
+  auto advance = [&]() {
+    union_begin = filter_begin;
+    union_end = filter_end;
+    filling = 1 - filling;
+    // Later walls mostly join cells already in one set. Once few survive,
+    // bigger batches keep the unions from waiting on every small batch.
+    if(kept.load(memory_order_relaxed) * 4 < filter_end - filter_begin) {
+      batch_size = min(2*batch_size, max_batch_size);
+    }
+    filter_begin = filter_end;
+    filter_end = min(filter_begin + batch_size, (size_t)permutation.size());
+    if(candidate[filling].size() < filter_end - filter_begin) {
+      candidate[filling].resize(filter_end - filter_begin);
+    }
+    kept.store(0, memory_order_relaxed);
+    next_chunk.store(0, memory_order_relaxed);
+    done = unions_left == 0 || union_begin == union_end;
+  };
+  // The calling thread unions the previous batch, then helps filter.
+  auto work = [&](const bool& unites) {
+    while(!done) {
+      if(unites) {
+        unite();
+      }
+      filter();
+      barrier.Wait(advance);
+    }
+  };
+
+  vector<thread> threads;
+  for(size_t t = 1; t < num_threads; ++t) {
+    threads.emplace_back(work, false);
+  }
+  work(true);
+  for(auto& t: threads) {
+    t.join();
+  }
+}
+
+void Maze::GenerateTiled(const size_t& tile_size, const size_t& num_threads,
+                         const uint64_t& seed) {
+  if(cells_.empty()) {
+    cout << "Maze is empty. Please initialize its dimensions." << endl;
+    return;
+  }
+  if(tile_size == 0 || tile_size > 65535) {
+    cout << "Tile size must be between 1 and 65535." << endl;
+    return;
+  }
+  cells_.Reset(); // tiles are carved from standing walls
+  set_ = DisjSets();
+  const size_t tile_rows = (num_rows_ + tile_size - 1) / tile_size;
+  const size_t tile_cols = (num_columns_ + tile_size - 1) / tile_size;
+  const size_t tile_count = tile_rows * tile_cols;
+
+  // Tiles touch disjoint cells and every cell owns its walls, so the threads
+  // share nothing but the tile counter.
+  atomic<size_t> next_tile(0);
+  auto worker = [&]() {
+    size_t tile, row, col;
+    while((tile = next_tile.fetch_add(1)) < tile_count) {
+      row = (tile / tile_cols) * tile_size;
+      col = (tile % tile_cols) * tile_size;
+      GenerateTile(row, col, min(tile_size, num_rows_ - row),
+                   min(tile_size, num_columns_ - col), DeriveSeed(seed, tile));
     }
+  };
+  vector<thread> threads;
+  for(size_t i = 1; i < num_threads; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for(auto& t: threads) {
+    t.join();
+  }
+
+  // Every tile is now one set, so stitching is Kruskal over tiles using only
+  // the walls on tile borders.
+  vector<pair<size_t, unsigned int>> border_walls;
+  for(size_t i = 0; i < cells_.size(); ++i) {
+    if(i % num_columns_ != num_columns_ - 1 && (i % num_columns_) % tile_size == tile_size - 1) {
+      border_walls.push_back(pair<size_t, unsigned int>(i,0));
+    }
+    if(i / num_columns_ != num_rows_ - 1 && (i / num_columns_) % tile_size == tile_size - 1) {
+      border_walls.push_back(pair<size_t, unsigned int>(i,1));
+    }
+  }
+  DisjSets tile_set(tile_count);
+  size_t unions_left = tile_count - 1;
+  size_t current_cell, neighbor, tile, neighbor_tile;
+  vector<size_t> border_samples = SampleRandomIndex(border_walls.size(),
+                                                    DeriveSeed(seed, tile_count),
+                                                    num_threads);
+  for(size_t i = 0; i < border_samples.size() && unions_left > 0; ++i) {
+    current_cell = border_walls[border_samples[i]].first;
+    neighbor = GetNeighborIndex(current_cell, border_walls[border_samples[i]].second);
+    tile = tile_set.Find(((current_cell / num_columns_) / tile_size) * tile_cols
+                         + (current_cell % num_columns_) / tile_size);
+    neighbor_tile = tile_set.Find(((neighbor / num_columns_) / tile_size) * tile_cols
+                                  + (neighbor % num_columns_) / tile_size);
+    if(tile != neighbor_tile) {
+      cells_.Break(current_cell, border_walls[border_samples[i]].second);
+      tile_set.UnionSets(tile, neighbor_tile);
+      --unions_left;
+    }
+  }
+}
+
+void Maze::GenerateTile(const size_t& row, const size_t& col,
+                        const size_t& rows, const size_t& cols,
+                        const uint64_t& seed) {
+  // Same implicit wall ids as BreakWalls, local to the tile.
+  SmallDisjSets tile_set(rows*cols);
+  FeistelPermutation permutation(2*rows*cols, seed);
+  size_t unions_left = rows*cols - 1;
+  size_t wall_id, local, local_neighbor, root, neighbor_root;
+  for(size_t i = 0; i < permutation.size() && unions_left > 0; ++i) {
+    wall_id = permutation(i);
+    local = wall_id / 2;
+    if(wall_id % 2 == 0 ? local % cols == cols - 1 : local / cols == rows - 1) {
+      continue;
+    }
+    local_neighbor = wall_id % 2 == 0 ? local + 1 : local + cols;
+    root = tile_set.Find(local);
+    neighbor_root = tile_set.Find(local_neighbor);
+    if(root != neighbor_root) {
+      // neighboring tiles can share a word of the wall store.
+      cells_.BreakConcurrent((row + local/cols)*num_columns_ + col + local%cols,
+                             wall_id % 2);
+      tile_set.UnionSets(root, neighbor_root);
+      --unions_left;
+    }
+  }
+}
+
+unsigned int Maze::CountOpenWalls(const size_t& cell) const {
+  unsigned int count = !cells_.HasRightWall(cell) + !cells_.HasBottomWall(cell);
+  if(cell % num_columns_ != 0) {
+    count += !cells_.HasRightWall(cell-1);
+  }
+  if(cell >= num_columns_) {
+    count += !cells_.HasBottomWall(cell-num_columns_);
   }
+  return count;
 }
 
-void Maze::InitializeWalls() {
+DisjSets Maze::SetFromWalls() const {
+  DisjSets set(cells_.size());
   for(size_t i = 0; i < cells_.size(); ++i) {
-    if(i % num_columns_ != num_columns_ - 1) {
-      walls_.push_back(pair<size_t, unsigned int>(i,0));
+    if(!cells_.HasRightWall(i)) {
+      set.UnionSets(set.Find(i), set.Find(i+1));
     }
-    if(i / num_columns_ != num_rows_ - 1) {
-      walls_.push_back(pair<size_t, unsigned int>(i,1));
+    if(!cells_.HasBottomWall(i)) {
+      set.UnionSets(set.Find(i), set.Find(i+num_columns_));
     }
   }
+  return set;
 }
 
 void Maze::SetScaledPixel(const size_t& i, const size_t& j, const size_t& scale,
                           Image* maze, const unsigned int& value) {
   size_t row_bound = i + scale;
-  size_t col_bound = j + scale;
 
   for(size_t x = i; x < row_bound; ++x) {
-    for(size_t y = j; y < col_bound; ++y) {
-      maze->SetPixel(x, y, value);
-    }
+    memset(maze->span(x, j, scale), value, scale);
   }
 }
 
@@ -316,6 +733,197 @@ void Maze::BreakWallImage(  const unsigned int& wall, // which side of the cell'
   }
 }
 
+string StatsToJson(const Maze& maze, const MazeStats& stats) {
+  const size_t columns = maze.num_columns();
+  ostringstream json;
+  json << "{\"rows\": " << maze.num_rows() << ", \"columns\": " << columns
+       << ", \"dead_ends\": " << stats.dead_ends
+       << ", \"junctions\": " << stats.junctions
+       << ", \"corridors\": " << stats.corridors
+       << ", \"corridor_histogram\": [";
+  for(size_t k = 0; k < stats.corridor_histogram.size(); ++k) {
+    json << (k ? ", " : "") << stats.corridor_histogram[k];
+  }
+  json << "], \"diameter\": " << stats.diameter
+       << ", \"diameter_start\": [" << stats.diameter_start / columns << ", "
+       << stats.diameter_start % columns << "], \"diameter_end\": ["
+       << stats.diameter_end / columns << ", " << stats.diameter_end % columns
+       << "], \"solution_length\": ";
+  if(stats.solution_length == SIZE_MAX) {
+    json << "null";
+  } else {
+    json << stats.solution_length;
+  }
+  json << "}";
+  return json.str();
+}
+
+void GenerateWithOptions(Maze* maze, const MazeOptions& options) {
+  unique_ptr<MazeGenerator> generator = MakeGenerator(options.algorithm, options);
+  if(!generator) {
+    cout << "ERROR: unknown algorithm " << options.algorithm
+         << ", using kruskal." << endl;
+    generator = MakeGenerator("kruskal", options);
+  }
+  maze->Generate(generator.get(), options.seed);
+  if(options.braid > 0) {
+    maze->Braid(options.braid, DeriveSeed(options.seed, 1));
+  }
+}
+
+bool AnswerQueries(const Maze& maze, const size_t& scale,
+                   const MazeOptions& options) {
+  ifstream input(options.queries);
+  if(!input) {
+    cout << "ERROR: can't read query file " << options.queries << endl;
+    return false;
+  }
+  vector<pair<size_t, size_t>> queries;
+  string line;
+  string fields[5];
+  for(size_t line_number = 1; getline(input, line); ++line_number) {
+    istringstream words(line);
+    size_t count = 0;
+    while(count < 5 && words >> fields[count]) {
+      ++count;
+    }
+    if(count == 0) {
+      continue;
+    }
+    if(count != 4 || !IsUnsignedNumber(fields[0]) || !IsUnsignedNumber(fields[1])
+       || !IsUnsignedNumber(fields[2]) || !IsUnsignedNumber(fields[3])
+       || StringToSizeT(fields[0]) >= maze.num_rows()
+       || StringToSizeT(fields[1]) >= maze.num_columns()
+       || StringToSizeT(fields[2]) >= maze.num_rows()
+       || StringToSizeT(fields[3]) >= maze.num_columns()) {
+      cout << "ERROR: " << options.queries << ':' << line_number
+           << ": expected start_row start_col end_row end_col within the maze."
+           << endl;
+      return false;
+    }
+    queries.push_back(pair<size_t, size_t>(
+        StringToSizeT(fields[0])*maze.num_columns() + StringToSizeT(fields[1]),
+        StringToSizeT(fields[2])*maze.num_columns() + StringToSizeT(fields[3])));
+  }
+
+  vector<size_t> lengths;
+  vector<vector<size_t>> paths;
+  const bool need_paths = options.query_paths || !options.query_images.empty();
+  if(!maze.SolveBatch(queries, options.num_threads, &lengths,
+                      need_paths ? &paths : nullptr, options.solver)) {
+    return false;
+  }
+
+  FILE* output = stdout;
+  if(!options.query_output.empty()) {
+    output = fopen(options.query_output.c_str(), "w");
+    if(output == nullptr) {
+      cout << "ERROR: can't write to file " << options.query_output << endl;
+      return false;
+    }
+  }
+  const size_t columns = maze.num_columns();
+  for(size_t q = 0; q < queries.size(); ++q) {
+    fprintf(output, "%zu %zu %zu %zu ", queries[q].first / columns,
+            queries[q].first % columns, queries[q].second / columns,
+            queries[q].second % columns);
+    if(lengths[q] == SIZE_MAX) {
+      fprintf(output, "-1");
+    } else {
+      fprintf(output, "%zu", lengths[q]);
+    }
+    if(options.query_paths) {
+      for(const auto& cell: paths[q]) {
+        fprintf(output, " %zu,%zu", cell / columns, cell % columns);
+      }
+    }
+    fputc('\n', output);
+  }
+  if(output != stdout) {
+    fclose(output);
+  }
+
+  bool ok = true;
+  if(!options.query_images.empty()) {
+    // one render of the maze, then every path is painted on, written and
+    // taken off again.
+    Image image = maze.get_image(scale);
+    PathOverlay overlay(maze, scale, &image);
+    PackedPath path;
+    for(size_t q = 0; q < queries.size(); ++q) {
+      path = PackedPath(queries[q].first, columns);
+      for(size_t i = 1; i < paths[q].size(); ++i) {
+        path.PushCell(paths[q][i]);
+      }
+      if(paths[q].empty()) {
+        path.Clear();
+      }
+      overlay.DrawPath(path, kPathShade);
+      overlay.DrawCell(queries[q].first, kStartShade);
+      overlay.DrawCell(queries[q].second, kEndShade);
+      const string filename = options.query_images + to_string(q) + ".pgm";
+      if(!WriteImage(filename, image)) {
+        cout << "ERROR: can't write to file " << filename << endl;
+        ok = false;
+      }
+      overlay.Clear();
+    }
+  }
+  return ok;
+}
+
+bool WriteDistanceField(Maze* maze, const size_t& source, const size_t& scale,
+                        const MazeOptions& options) {
+  vector<uint32_t> distance;
+  ComputeDistanceField(*maze, source, options.num_threads, &distance);
+  bool ok = true;
+  if(!options.heatmap.empty()) {
+    if(!WriteImage(options.heatmap, maze->get_heatmap(distance, scale))) {
+      cout << "ERROR: can't write to file " << options.heatmap << endl;
+      ok = false;
+    }
+  }
+  if(!options.distances.empty()) {
+    FILE* output = fopen(options.distances.c_str(), "wb");
+    if(output == nullptr
+       || fwrite(distance.data(), sizeof(uint32_t), distance.size(), output)
+          != distance.size()) {
+      cout << "ERROR: can't write to file " << options.distances << endl;
+      ok = false;
+    }
+    if(output != nullptr) {
+      fclose(output);
+    }
+  }
+  return ok;
+}
+
+namespace {
+
+// Writes the image renderer draws to filename, in parallel bands when
+// options asks for more than one thread. The "packed" format writes
+// unsolved mazes as 1 bit pbm and solved ones as 4 bit bmp, one thread,
+// and "png" deflates on every thread.
+// @return true if everything is OK, false otherwise.
+bool WriteRendered(const string& filename, ScanlineRenderer* renderer,
+                   const MazeOptions& options) {
+  if(options.format == "png") {
+    return WriteMazeImage(filename, renderer, MazeImageFormat::kPng,
+                          options.num_threads);
+  }
+  if(options.format == "packed") {
+    return WriteMazeImage(filename, renderer, renderer->solved()
+                                              ? MazeImageFormat::kBmp
+                                              : MazeImageFormat::kPbm);
+  }
+  if(options.num_threads > 1) {
+    return WriteMazeImage(filename, *renderer, options.num_threads);
+  }
+  return WriteMazeImage(filename, renderer);
+}
+
+}  // namespace
+
 void GenerateMaze(  const string& scale_string,
                     const string& rows_string,
                     const string& columns_string,
@@ -324,7 +932,8 @@ void GenerateMaze(  const string& scale_string,
                     const string& start_col_string,
                     const string& end_row_string,
                     const string& end_col_string,
-                    const string& solved_output) {
+                    const string& solved_output,
+                    const MazeOptions& options) {
 
   if( IsUnsignedNumber(scale_string) && IsUnsignedNumber(rows_string)
       && IsUnsignedNumber(columns_string) && IsUnsignedNumber(start_row_string)
@@ -339,24 +948,48 @@ void GenerateMaze(  const string& scale_string,
     size_t rows = StringToSizeT(rows_string);
     size_t columns = StringToSizeT(columns_string);
 
+    if(options.stream) {
+      // the streamed maze is gone once written, so there is nothing to solve.
+      GenerateMaze(scale_string, rows_string, columns_string, unsolved_output, options);
+      cout << "ERROR: solving is not supported with --stream." << endl;
+      cout << "Solved maze not generated." << endl;
+      return;
+    }
+
     Maze my_maze(rows, columns);
-    my_maze.Generate();
-    Image* unsolved = my_maze.get_image(scale);
-    if (!WriteImage(unsolved_output, *unsolved)){
+    GenerateWithOptions(&my_maze, options);
+    ScanlineRenderer renderer(my_maze, scale);
+    if (!WriteRendered(unsolved_output, &renderer, options)){
       cout << "ERROR: can't write to file " << unsolved_output << endl;
     }
+    if(!options.queries.empty()) {
+      AnswerQueries(my_maze, scale, options);
+    }
+    if(options.stats && end_row < rows && end_col < columns
+       && start_row < rows && start_col < columns) {
+      cout << StatsToJson(my_maze, my_maze.Analyze(start_row*columns + start_col,
+                                                   end_row*columns + end_col))
+           << endl;
+    }
+    if((!options.heatmap.empty() || !options.distances.empty())
+       && start_row < rows && start_col < columns) {
+      WriteDistanceField(&my_maze, start_row*columns + start_col, scale, options);
+    }
 
     if( end_row < rows && end_col < columns &&
         start_row < rows && start_col < columns) {
-      Image* solved = my_maze.get_solved_image( start_row,
-                                                start_col,
-                                                end_row,
-                                                end_col,
-                                                scale);
-
-      if (!solved || !WriteImage(solved_output, *solved)){
+      const size_t start = start_row*columns + start_col;
+      const size_t end = end_row*columns + end_col;
+      PackedPath path;
+      const bool found = my_maze.Solve(start, end, &path);
+      renderer.SetSolution(path, start, end);
+      if (!WriteRendered(solved_output, &renderer, options)){
         cout << "ERROR: can't write to file " << solved_output << endl;
       }
+      if(!options.path_output.empty() && found
+         && !WritePath(options.path_output, path)) {
+        cout << "ERROR: can't write to file " << options.path_output << endl;
+      }
     } else {
       cout << "ERROR: starting or ending index out of bounds." << endl;
       cout << "Solved maze not generated." << endl;
@@ -370,23 +1003,44 @@ void GenerateMaze(  const string& scale_string,
 void GenerateMaze(  const string& scale_string,
                     const string& rows_string,
                     const string& columns_string,
-                    const string& unsolved_output) {
+                    const string& unsolved_output,
+                    const MazeOptions& options) {
 
-  if(IsUnsignedNumber(scale_string) && IsUnsignedNumber(rows_string) && IsUnsignedNumber(columns_string)) {
+  if(IsUnsignedNumber(scale_string) && IsUnsignedNumber(rows_string) && IsUnsignedNumber(columns_string)
+     && options.stream) {
+    if(!WriteStreamingMaze(StringToSizeT(rows_string), StringToSizeT(columns_string),
+                           StringToSizeT(scale_string), unsolved_output,
+                           options.seed)) {
+      cout << "ERROR: can't write to file " << unsolved_output << endl;
+    }
+    if(!options.queries.empty() || options.stats || !options.heatmap.empty()
+       || !options.distances.empty()) {
+      cout << "ERROR: --queries, --stats, --heatmap and --distances are not "
+           << "supported with --stream." << endl;
+    }
+  } else if(IsUnsignedNumber(scale_string) && IsUnsignedNumber(rows_string) && IsUnsignedNumber(columns_string)) {
     Maze my_maze(StringToSizeT(rows_string), StringToSizeT(columns_string));
-    my_maze.Generate();
-    Image* unsolved = my_maze.get_image(StringToSizeT(scale_string));
-
-    if (!WriteImage(unsolved_output, *unsolved)){
+    GenerateWithOptions(&my_maze, options);
+    ScanlineRenderer renderer(my_maze, StringToSizeT(scale_string));
+    if (!WriteRendered(unsolved_output, &renderer, options)){
       cout << "ERROR: can't write to file " << unsolved_output << endl;
     }
+    if(!options.queries.empty()) {
+      AnswerQueries(my_maze, StringToSizeT(scale_string), options);
+    }
+    if(options.stats) {
+      cout << StatsToJson(my_maze, my_maze.Analyze(0, my_maze.size() - 1)) << endl;
+    }
+    if(!options.heatmap.empty() || !options.distances.empty()) {
+      WriteDistanceField(&my_maze, 0, StringToSizeT(scale_string), options);
+    }
   } else {
     cout << "ERROR: invalid dimensions " << rows_string << " * " << columns_string << ',' << endl;
     cout << "Dimensions must be unsigned number." << endl;
   }
 }
 
-void GenerateMaze() {
+void GenerateMaze(const MazeOptions& options) {
   string scale_string;
   string rows_string;
   string columns_string;
@@ -418,12 +1072,20 @@ void GenerateMaze() {
   size_t columns = StringToSizeT(columns_string);
 
   Maze my_maze(rows, columns);
-  my_maze.Generate();
-  Image* im = my_maze.get_image(scale);
-
-  if (!WriteImage(output, *im)){
+  GenerateWithOptions(&my_maze, options);
+  ScanlineRenderer renderer(my_maze, scale);
+  if (!WriteRendered(output, &renderer, options)){
     cout << "Can't write to file " << output << endl;
   }
+  if(!options.queries.empty()) {
+    AnswerQueries(my_maze, scale, options);
+  }
+  if(options.stats) {
+    cout << StatsToJson(my_maze, my_maze.Analyze(0, my_maze.size() - 1)) << endl;
+  }
+  if(!options.heatmap.empty() || !options.distances.empty()) {
+    WriteDistanceField(&my_maze, 0, scale, options);
+  }
 
   string start_row_string;
   string start_col_string;
@@ -477,12 +1139,12 @@ void GenerateMaze() {
 
   if( end_row < rows && end_col < columns &&
       start_row < rows && start_col < columns) {
-    Image* solved = my_maze.get_solved_image( start_row,
-                                              start_col,
-                                              end_row,
-                                              end_col,
-                                              scale);
-    if (!solved || !WriteImage(solved_output, *solved)){
+    const size_t start = start_row*columns + start_col;
+    const size_t end = end_row*columns + end_col;
+    PackedPath path;
+    my_maze.Solve(start, end, &path);
+    renderer.SetSolution(path, start, end);
+    if (!WriteRendered(solved_output, &renderer, options)){
       cout << "ERROR: can't write to file " << solved_output << endl;
     }
   } else {
@@ -503,9 +1165,9 @@ void GenerateGrid(const string& scale_string,
     size_t columns = StringToSizeT(columns_string);
 
     Maze my_maze(rows, columns);
-    Image* grid = my_maze.get_grid(rows, columns, scale);
+    Image grid = my_maze.get_grid(rows, columns, scale);
 
-    if (!WriteImage(output, *grid)){
+    if (!WriteImage(output, grid)){
       cout << "ERROR: can't write to file " << output << endl;
     }
   } else {
@@ -546,9 +1208,9 @@ void GenerateGrid() {
   size_t columns = StringToSizeT(columns_string);
 
   Maze my_maze(rows, columns);
-  Image* grid = my_maze.get_grid(rows, columns, scale);
+  Image grid = my_maze.get_grid(rows, columns, scale);
 
-  if (!WriteImage(output, *grid)){
+  if (!WriteImage(output, grid)){
     cout << "Can't write to file " << output << endl;
   }
 
@@ -3,6 +3,8 @@
 #ifndef MAZE_H
 #define MAZE_H
 
+#include <algorithm>
+#include <cstdint>
 #include <forward_list>
 #include <vector>
 #include "image.h"
@@ -11,43 +13,75 @@
 
 using namespace image;
 
-class Cell {
+class MazeGenerator;
+class PackedPath;
+
+// Shape of a maze as computed by Maze::Analyze.
+struct MazeStats {
+  size_t dead_ends = 0; // cells with one open wall
+  size_t junctions = 0; // cells with three or four open walls
+  size_t corridors = 0; // passages between cells that are not corridor cells
+  // corridor_histogram[k] counts corridors of 2^k to 2^(k+1)-1 moves.
+  vector<size_t> corridor_histogram;
+  size_t diameter = 0; // moves on the longest shortest path
+  size_t diameter_start = 0; // cell at one end of that path
+  size_t diameter_end = 0; // cell at the other end
+  size_t solution_length = SIZE_MAX; // moves from start to end, if reachable
+};
+
+/**
+* Walls of every cell packed into two bitplanes of 64 bit words, one bit per
+* cell for its right wall and one for its bottom wall. A set bit means the
+* wall is there. Cells are addressed by their one dimensional index, so the
+* store is 2 bits per cell in two contiguous arrays.
+*/
+class WallStore {
   public:
-    Cell() {
-      walls_ = vector<bool>(wall_count_, true);
-    }
-    Cell(const vector<bool>& walls) {
-      if(walls.size() == 2) {
-        walls_ = walls;
-      }
-    }
-    Cell(vector<bool>&& walls) {
-      if(walls.size() == 2) {
-        walls_ = std::move(walls);
-      }
-    }
-    bool HasRightWall() const {
-      return walls_[0];
+    WallStore(): size_{0} {}
+    // @param size is the number of cells, all walls start standing.
+    explicit WallStore(const size_t& size)
+        : size_(size), right_((size + 63) / 64, ~0ULL),
+          bottom_((size + 63) / 64, ~0ULL) {}
+
+    bool HasRightWall(const size_t& i) const {
+      return (right_[i >> 6] >> (i & 63)) & 1;
     }
-    bool HasBottomWall()const {
-      return walls_[1];
+    bool HasBottomWall(const size_t& i) const {
+      return (bottom_[i >> 6] >> (i & 63)) & 1;
     }
-    unsigned int get_wall_count() const {
-      return wall_count_;
+    // @param wall is the wall index [0,1] = [right, bottom]
+    void Break(const size_t& i, const unsigned int& wall) {
+      Plane(wall)[i >> 6] &= ~(1ULL << (i & 63));
     }
-    vector<bool> get_walls() const {
-      return walls_;
+    // Same as Break but safe while other threads break walls of cells that
+    // share the word.
+    void BreakConcurrent(const size_t& i, const unsigned int& wall) {
+      __atomic_fetch_and(&Plane(wall)[i >> 6], ~(1ULL << (i & 63)),
+                         __ATOMIC_RELAXED);
     }
-    void Break(unsigned int i) {
-      walls_[i%wall_count_] = false;
+    // Puts every wall back up.
+    void Reset() {
+      fill(right_.begin(), right_.end(), ~0ULL);
+      fill(bottom_.begin(), bottom_.end(), ~0ULL);
     }
-    void Print() const {
-      printf("R:%d B:%d", walls_[0],walls_[1]);
+    void Print(const size_t& i) const {
+      printf("R:%d B:%d", HasRightWall(i), HasBottomWall(i));
     }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    // @return words of the right wall plane, bit i%64 of word i/64 is cell i.
+    const vector<uint64_t>& right_walls() const { return right_; }
+    // @return words of the bottom wall plane.
+    const vector<uint64_t>& bottom_walls() const { return bottom_; }
 
   private:
-    const static unsigned int wall_count_ = 2;
-    vector<bool> walls_; // true means wall is there
+    vector<uint64_t>& Plane(const unsigned int& wall) {
+      return wall % 2 == 0 ? right_ : bottom_;
+    }
+
+    size_t size_;
+    vector<uint64_t> right_;
+    vector<uint64_t> bottom_;
 };
 
 /**
@@ -69,55 +103,174 @@ class Maze {
     // @param cols determing the number of cells for the width of the maze.
     explicit Maze(const size_t& rows, const size_t& cols);
     explicit Maze(size_t&& rows, size_t&& cols);
-    Maze& operator=(const Maze& rhs);
 
     // Generates randomixed maze and stores it in cells_.
-    // Generates randomized walls from cells_ and stores it in walls_.
-    void Generate();
+    // Walls are visited in the order of a seeded FeistelPermutation over
+    // their ids, so no wall list or shuffle buffer is allocated.
+    // @param num_threads is the number of threads shuffling and filtering
+    // walls. With more than one thread the walls are filtered through a
+    // ConcurrentDisjSets.
+    // @param seed determines the maze. The same seed gives the same maze for
+    // any num_threads.
+    void Generate(const size_t& num_threads = 1,
+                  const uint64_t& seed = RandomSeed());
+    // Splits the grid into tile_size*tile_size tiles and generates each tile
+    // as an independent maze on its own thread with a local DisjSets. A final
+    // pass opens randomly chosen walls on tile borders, only where they join
+    // different tiles, so the result is still a single acyclic maze.
+    // @param tile_size is the side of a square tile in cells, at most 65535
+    // so a tile's set fits 32 bit indices.
+    // @param num_threads is the number of threads generating tiles.
+    // @param seed determines the maze together with tile_size.
+    void GenerateTiled(const size_t& tile_size, const size_t& num_threads = 1,
+                       const uint64_t& seed = RandomSeed());
+    // Puts every wall back up and lets generator open walls until the maze
+    // is perfect. See maze_generator.h for the available algorithms.
+    void Generate(MazeGenerator* generator, const uint64_t& seed = RandomSeed());
+    // Removes dead ends, making loops. Each dead end is picked with
+    // probability fraction and gets one more wall opened, to a neighboring
+    // dead end when there is one. The maze is no longer perfect, so Solve's
+    // paths stay shortest but MazeTree's do not.
+    // @param fraction of dead ends to remove, from 0 to 1.
+    // @param seed determines which dead ends and walls are picked.
+    void Braid(const double& fraction, const uint64_t& seed = RandomSeed());
     void PrintCells() const;
     void PrintWalls() const;
     void PrintSet() const;
 
     // @param scale in pixels of size of each cell.
-    // @return scaled .pgm grayscale image of the maze.
-    Image* get_image(const size_t& scale = 10);
+    // @return scaled .pgm grayscale image of the maze, see
+    // ScanlineRenderer.
+    Image get_image(const size_t& scale = 10) const;
     // @param (start_row, start_col) two dimensional starting index.
     // @param (end_row, end_col) two dimensional ending index.
     // @param scale square cell dimension in pixels.
-    // @return .pgm file of solved maze.
-    Image* get_solved_image(const size_t& start_row, const size_t& start_col,
-                            const size_t& end_row, const size_t& end_col,
-                            const size_t& scale);
+    // @return .pgm file of solved maze, empty if an index is out of bounds.
+    Image get_solved_image(const size_t& start_row, const size_t& start_col,
+                           const size_t& end_row, const size_t& end_col,
+                           const size_t& scale);
     // @param start one dimensional starting index.
     // @param end one dimensional ending index.
     // @param scale square cell dimension in pixels.
-    // @return .pgm file of solved maze.
-    Image* get_solved_image(const size_t& start, const size_t& end,
-                            const size_t& scale);
+    // @return .pgm file of solved maze, empty if an index is out of bounds.
+    Image get_solved_image(const size_t& start, const size_t& end,
+                           const size_t& scale);
+    // @param path is drawn cell by cell as it is decoded, see PackedPath.
+    // @param scale square cell dimension in pixels.
+    // @return .pgm file of the maze with path drawn on it.
+    Image get_solved_image(const PackedPath& path, const size_t& scale);
     // @param rows is the number of rows of cells.
     // @param columns is the number of columns of cells.
     // @param scale square cell dimension in pixels.
     // @return .pgm file of cell layout and how they are indexed.
-    Image* get_grid(const size_t& rows, const size_t& columns,
-                    const size_t& scale);
-    // Breadth first search solution to maze.
-    // size_t template parameter is the index of the cell in cells_ vector.
+    Image get_grid(const size_t& rows, const size_t& columns,
+                   const size_t& scale);
+    // @param distance is the number of moves from a source to every cell,
+    // see ComputeDistanceField.
+    // @param scale square cell dimension in pixels.
+    // @return .pgm image of the maze with every cell shaded from white at
+    // the source to dark gray at the farthest cell. Walls are black and
+    // cells that can't be reached are gray value 20.
+    Image get_heatmap(const vector<uint32_t>& distance, const size_t& scale);
+    // Computes the MazeStats of the maze in one pass over the walls and two
+    // breadth first sweeps. The second sweep starts at the cell farthest
+    // from start, which gives the exact diameter of a perfect maze and a
+    // lower bound once it is braided. Memory is one word and one bit per
+    // cell.
+    // @param start and end are the cells solution_length is measured
+    // between.
+    MazeStats Analyze(const size_t& start, const size_t& end) const;
+    // Breadth first search solution to maze, see BfsSolver. Keep a BfsSolver
+    // around instead to solve many times without allocating.
     // @param start is the index of starting cell in cells_ vector.
     // @param end is the index of ending cell in cells_ vector.
     // @return an ordered list of indices to follow to reach from start to end
     // in the maze.
     forward_list<size_t> Solve(const size_t& start, const size_t& end) const;
+    // Same as Solve with the path packed 2 bits per move, against a list
+    // node per cell. Prefer it for long paths.
+    // @param path gets the moves from start to end, or is cleared if end
+    // can't be reached.
+    // @return true if end was reached.
+    bool Solve(const size_t& start, const size_t& end, PackedPath* path) const;
+    // Solves every (start, end) pair of queries on num_threads threads. The
+    // maze is only read, and each thread keeps its own solver, so no query
+    // allocates search state.
+    // @param lengths gets the number of moves of each query, SIZE_MAX if end
+    // can't be reached. May be nullptr.
+    // @param paths gets the cells from start to end of each query, empty if
+    // end can't be reached. May be nullptr.
+    // @param solver names the MazeSolver each thread uses, see MakeSolver.
+    // @return false, leaving lengths and paths untouched, if solver is
+    // unknown.
+    bool SolveBatch(const vector<pair<size_t, size_t>>& queries,
+                    const size_t& num_threads, vector<size_t>* lengths,
+                    vector<vector<size_t>>* paths = nullptr,
+                    const string& solver = "bfs") const;
+
+    size_t num_rows() const { return num_rows_; }
+    size_t num_columns() const { return num_columns_; }
+    // @return total number of cells.
+    size_t size() const { return cells_.size(); }
+    bool HasRightWall(const size_t& cell_index) const {
+      return cells_.HasRightWall(cell_index);
+    }
+    bool HasBottomWall(const size_t& cell_index) const {
+      return cells_.HasBottomWall(cell_index);
+    }
+    // @return walls of every cell, see WallStore.
+    const WallStore& walls() const { return cells_; }
+    // Opens a wall without touching set_. Used by generators that keep their
+    // own bookkeeping.
+    // @param wall is the wall index [0,1] = [right, bottom]
+    void OpenWall(const size_t& cell_index, const unsigned int& wall) {
+      cells_.Break(cell_index, wall);
+    }
 
   private:
     // @param current is the current cell's index.
     // @param wall is the wall index [0,1] = [right, bottom]
     // @return index of neighboring cell separated by the wall
-    size_t GetNeighborIndex(const size_t& current, const unsigned int& wall);
+    size_t GetNeighborIndex(const size_t& current, const unsigned int& wall) const;
     void BreakWall( const size_t& cell_index, const size_t& neighbor,
                     const unsigned int& wall);
-    // @param random_indices are randomized indices from indices of walls_.
-    void BreakWalls(const vector<size_t>& random_indices);
-    void InitializeWalls();
+    // A wall is addressed by its id 2*cell + wall, wall being [0,1] =
+    // [right, bottom]. Ids of the right walls of the last column and the
+    // bottom walls of the last row are on the boundary and not in the pool.
+    // @return true if wall_id is an interior wall.
+    bool IsInteriorWall(const size_t& wall_id) const;
+    // Single pass over the wall ids in permutation order. Stops as soon as
+    // all cells are in the same set, i.e. after rows*cols-1 successful unions.
+    // @param permutation is a random order of the 2*rows*cols wall ids.
+    void BreakWalls(const FeistelPermutation& permutation);
+    // Filter-Kruskal over batches of the shuffled walls. One pool of threads
+    // drops the walls of a batch whose cells are already in one set, using
+    // only Find on a shared lock-free set, while the calling thread unions
+    // the remaining walls of the batch before it in order. Batches grow as
+    // fewer walls survive. A wall dropped early would also be rejected by
+    // BreakWalls, so the maze is the one BreakWalls builds from the same
+    // shuffle.
+    void BreakWallsConcurrent(const FeistelPermutation& permutation,
+                              const size_t& num_threads);
+    // Randomized Kruskal restricted to the cells of one tile.
+    // @param (row, col) is the top left cell of the tile.
+    // @param (rows, cols) are the dimensions of the tile in cells.
+    // @param seed determines the tile's maze.
+    void GenerateTile(const size_t& row, const size_t& col,
+                      const size_t& rows, const size_t& cols,
+                      const uint64_t& seed);
+    // Breadth first search from source, one level at a time.
+    // @param queue and visited are scratch of size() words and bits.
+    // @param distance gets the moves to the farthest cell.
+    // @param end_distance gets the moves to end, SIZE_MAX if not reached.
+    // @return the first cell of the last level, one farthest from source.
+    size_t Sweep(const size_t& source, const size_t& end, vector<size_t>* queue,
+                 vector<uint64_t>* visited, size_t* distance,
+                 size_t* end_distance) const;
+    // @return number of open walls around cell.
+    unsigned int CountOpenWalls(const size_t& cell) const;
+    // @return sets of cells joined by the open walls in cells_.
+    DisjSets SetFromWalls() const;
     // @param (i,j) are the scaled indices of the scaled image.
     // @param scale is the scale.
     // sets the value of a scale*scale pixel area to white starting at (i,j).
@@ -138,13 +291,62 @@ class Maze {
     // @return true if current and neighbor are in same set.
     bool IsInSameSet(const size_t& current, const size_t& neighbor);
 
-    DisjSets set_; // one dimensional set for storing "connectedness" of cells
-    vector<Cell> cells_; // one dimensional representation of a maze.
-    vector<pair<size_t, unsigned int>> walls_; // <index, wall number> pairs
+    // "connectedness" of cells, only filled by the serial Kruskal path;
+    // empty otherwise.
+    DisjSets set_;
+    WallStore cells_; // one dimensional representation of a maze.
     size_t num_rows_; // total number of rows of cells
     size_t num_columns_; // total number of columns of cells
 };
 
+// Settings for the GenerateMaze entry points that are not part of the
+// positional arguments.
+struct MazeOptions {
+  size_t num_threads = 1; // threads used to generate the maze
+  size_t tile_size = 0; // side of a generation tile in cells, 0 for no tiles
+  bool stream = false; // generate row by row straight into the output file
+  string algorithm = "kruskal"; // generation algorithm, see MakeGenerator
+  uint64_t seed = RandomSeed(); // same seed and options give the same maze
+  double braid = 0; // fraction of dead ends removed after generation
+  string solver = "bfs"; // algorithm answering queries, see MakeSolver
+  string queries; // file of start and end cells to solve, see AnswerQueries
+  string query_output; // file for the answers, standard output if empty
+  bool query_paths = false; // write the cells of each path with its length
+  string query_images; // prefix of one solved image per query, see AnswerQueries
+  bool stats = false; // print Maze::Analyze as JSON after generation
+  string heatmap; // file for the distance field image, see get_heatmap
+  string distances; // file for the raw distance field, see WriteDistanceField
+  string path_output; // file for the solved path, see PathWriter
+  string format = "pgm"; // maze image files, "pgm", "packed" or "png"
+};
+
+// @return stats as one line of JSON, cells given as [row, column].
+string StatsToJson(const Maze& maze, const MazeStats& stats);
+
+// Generates maze with the algorithm selected by options, then braids it.
+void GenerateWithOptions(Maze* maze, const MazeOptions& options);
+
+// Reads options.queries, one "start_row start_col end_row end_col" query per
+// line, solves them all with Maze::SolveBatch on options.num_threads threads
+// and writes one line per query to options.query_output: the query followed
+// by its number of moves, then "row,col" of every cell on the path if
+// options.query_paths is set. If options.query_images is set, query q also
+// gets the solved image <query_images><q>.pgm, q counting from 0; the maze is
+// rendered once and each path painted over it with a PathOverlay.
+// @param scale square cell dimension in pixels of the images.
+// @return true if everything is OK, false otherwise.
+bool AnswerQueries(const Maze& maze, const size_t& scale,
+                   const MazeOptions& options);
+
+// Computes the distance from source to every cell with ComputeDistanceField
+// on options.num_threads threads, then writes options.heatmap as an image
+// and options.distances as one native endian uint32 per cell in row major
+// order, each only if set. Cells that can't be reached are 4294967295.
+// @param scale square cell dimension in pixels of the heatmap.
+// @return true if everything is OK, false otherwise.
+bool WriteDistanceField(Maze* maze, const size_t& source, const size_t& scale,
+                        const MazeOptions& options);
+
 void GenerateMaze(  const string& scale_string,
                     const string& rows_string,
                     const string& columns_string,
@@ -153,14 +355,16 @@ void GenerateMaze(  const string& scale_string,
                     const string& start_col_string,
                     const string& end_row_string,
                     const string& end_col_string,
-                    const string& solved_output);
+                    const string& solved_output,
+                    const MazeOptions& options = MazeOptions());
 
 void GenerateMaze(  const string& scale_string,
                     const string& rows_string,
                     const string& columns_string,
-                    const string& unsolved_output);
+                    const string& unsolved_output,
+                    const MazeOptions& options = MazeOptions());
 
-void GenerateMaze();
+void GenerateMaze(const MazeOptions& options = MazeOptions());
 
 void GenerateGrid(const string& scale_string,
                   const string& rows_string,
@@ -0,0 +1,1120 @@
+// Created by Wei Shi
+// Scaling benchmarks for maze generation.
+#include <chrono>
+#include <cstring>
+#include <forward_list>
+#include <malloc.h>
+#include <queue>
+#include <set>
+#include <unordered_map>
+#include <iostream>
+#include <thread>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "infinite_maze.h"
+#include "maze.h"
+#include "maze_generator.h"
+#include "maze_render.h"
+#include "maze_solver.h"
+#include "packed_path.h"
+
+using namespace std;
+
+namespace {
+
+double SecondsSince(const chrono::steady_clock::time_point& start) {
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Generates square mazes of 10^3, 10^4, ... cells up to max_cells and prints
+// the time per cell. Linear generation shows as a flat ns/cell column.
+void BenchmarkGenerate(const size_t& max_cells) {
+  printf("%-12s %-12s %-12s %-10s\n", "cells", "seconds", "cells/sec", "ns/cell");
+  for(size_t cells = 1000; cells <= max_cells; cells *= 10) {
+    size_t side = 1;
+    while((side+1)*(side+1) <= cells) {
+      ++side;
+    }
+    Maze maze(side, side);
+    auto start = chrono::steady_clock::now();
+    maze.Generate();
+    double seconds = SecondsSince(start);
+    size_t total = side*side;
+    printf("%-12zu %-12.4f %-12.0f %-10.1f\n", total, seconds,
+           total/seconds, 1e9*seconds/total);
+  }
+}
+
+// Generates one maze of about max_cells cells with 1, 2, 4, ... threads up
+// to max_threads and prints the speedup over one thread.
+void BenchmarkGenerateThreads(const size_t& max_cells, const size_t& max_threads) {
+  size_t side = 1;
+  while((side+1)*(side+1) <= max_cells) {
+    ++side;
+  }
+  printf("%-12s %-12s %-12s %-10s\n", "threads", "seconds", "cells/sec", "speedup");
+  double single_thread_seconds = 0;
+  for(size_t threads = 1; threads <= max_threads; threads *= 2) {
+    Maze maze(side, side);
+    auto start = chrono::steady_clock::now();
+    maze.Generate(threads);
+    double seconds = SecondsSince(start);
+    if(threads == 1) {
+      single_thread_seconds = seconds;
+    }
+    printf("%-12zu %-12.4f %-12.0f %-10.2f\n", threads, seconds,
+           side*side/seconds, single_thread_seconds/seconds);
+  }
+}
+
+// Same as BenchmarkGenerateThreads but with tiled generation.
+void BenchmarkGenerateTiled(const size_t& max_cells, const size_t& max_threads,
+                            const size_t& tile_size) {
+  size_t side = 1;
+  while((side+1)*(side+1) <= max_cells) {
+    ++side;
+  }
+  printf("%-12s %-12s %-12s %-10s\n", "threads", "seconds", "cells/sec", "speedup");
+  double single_thread_seconds = 0;
+  for(size_t threads = 1; threads <= max_threads; threads *= 2) {
+    Maze maze(side, side);
+    auto start = chrono::steady_clock::now();
+    maze.GenerateTiled(tile_size, threads);
+    double seconds = SecondsSince(start);
+    if(threads == 1) {
+      single_thread_seconds = seconds;
+    }
+    printf("%-12zu %-12.4f %-12.0f %-10.2f\n", threads, seconds,
+           side*side/seconds, single_thread_seconds/seconds);
+  }
+}
+
+// Shuffles 2*max_cells wall indices with 1, 2, 4, ... threads.
+void BenchmarkShuffle(const size_t& max_cells, const size_t& max_threads) {
+  printf("%-12s %-12s %-12s %-10s\n", "threads", "seconds", "walls/sec", "speedup");
+  double single_thread_seconds = 0;
+  for(size_t threads = 1; threads <= max_threads; threads *= 2) {
+    auto start = chrono::steady_clock::now();
+    vector<size_t> samples = SampleRandomIndex(2*max_cells, 1, threads);
+    double seconds = SecondsSince(start);
+    if(threads == 1) {
+      single_thread_seconds = seconds;
+    }
+    printf("%-12zu %-12.4f %-12.0f %-10.2f\n", threads, seconds,
+           2*max_cells/seconds, single_thread_seconds/seconds);
+  }
+}
+
+// Reads a "Name:   value kB" line from /proc/self/status.
+// @return the value in kilobytes, 0 if the field is missing.
+long ReadStatusKilobytes(const char* field) {
+  FILE* status = fopen("/proc/self/status", "r");
+  if(status == nullptr) {
+    return 0;
+  }
+  char line[256];
+  long kilobytes = 0;
+  size_t length = strlen(field);
+  while(fgets(line, sizeof line, status)) {
+    if(strncmp(line, field, length) == 0 && line[length] == ':') {
+      kilobytes = atol(line + length + 1);
+      break;
+    }
+  }
+  fclose(status);
+  return kilobytes;
+}
+
+// Lowers the peak resident set size to the current one, so a forked child
+// does not inherit the parent's peak.
+// @return the current resident set size in kilobytes.
+long ResetPeakResident() {
+  malloc_trim(0);
+  FILE* clear_refs = fopen("/proc/self/clear_refs", "w");
+  if(clear_refs != nullptr) {
+    fputs("5", clear_refs);
+    fclose(clear_refs);
+  }
+  return ReadStatusKilobytes("VmRSS");
+}
+
+// @return peak resident set size of this process in kilobytes.
+long PeakResidentKilobytes() {
+  return ReadStatusKilobytes("VmHWM");
+}
+
+// Builds and generates a maze of about max_cells cells with every algorithm
+// from GeneratorNames. Each run happens in a forked child so the peak memory
+// of one algorithm does not hide the next one's.
+void BenchmarkGenerators(const size_t& max_cells) {
+  size_t side = 1;
+  while((side+1)*(side+1) <= max_cells) {
+    ++side;
+  }
+  printf("%-12s %-12s %-12s %-10s\n", "algorithm", "seconds", "cells/sec", "peak MB");
+  for(const auto& name: GeneratorNames()) {
+    fflush(stdout);
+    pid_t child = fork();
+    if(child == 0) {
+      Maze maze(side, side);
+      // the wall store is shared by every algorithm; only count the
+      // generator's own working memory.
+      long baseline = ResetPeakResident();
+      auto start = chrono::steady_clock::now();
+      unique_ptr<MazeGenerator> generator = MakeGenerator(name, MazeOptions());
+      maze.Generate(generator.get(), 1);
+      double seconds = SecondsSince(start);
+      printf("%-12s %-12.4f %-12.0f %-10.1f\n", name.c_str(), seconds,
+             side*side/seconds, (PeakResidentKilobytes() - baseline)/1024.0);
+      fflush(stdout);
+      _exit(0);
+    }
+    waitpid(child, nullptr, 0);
+  }
+}
+
+// Wall layout before WallStore: one heap allocated vector<bool> per cell
+// holding its right and bottom wall.
+class LegacyWalls {
+  public:
+    explicit LegacyWalls(const size_t& size) : cells_(size, vector<bool>(2, true)) {}
+    bool HasRightWall(const size_t& i) const { return cells_[i][0]; }
+    bool HasBottomWall(const size_t& i) const { return cells_[i][1]; }
+    void Break(const size_t& i, const unsigned int& wall) { cells_[i][wall] = false; }
+
+  private:
+    vector<vector<bool>> cells_;
+};
+
+// Breadth first search over every cell reachable from cell 0, the access
+// pattern of Maze::Solve.
+// @return number of cells reached.
+template <typename Walls>
+size_t TraverseWalls(const Walls& walls, const size_t& rows, const size_t& cols) {
+  vector<char> visited(rows*cols, false);
+  vector<size_t> queue(1, 0);
+  visited[0] = true;
+  for(size_t head = 0; head < queue.size(); ++head) {
+    size_t cell = queue[head];
+    size_t next[4];
+    int count = 0;
+    if(cell % cols != 0 && !walls.HasRightWall(cell-1)) next[count++] = cell-1;
+    if(cell >= cols && !walls.HasBottomWall(cell-cols)) next[count++] = cell-cols;
+    if(!walls.HasRightWall(cell)) next[count++] = cell+1;
+    if(!walls.HasBottomWall(cell)) next[count++] = cell+cols;
+    for(int k = 0; k < count; ++k) {
+      if(!visited[next[k]]) {
+        visited[next[k]] = true;
+        queue.push_back(next[k]);
+      }
+    }
+  }
+  return queue.size();
+}
+
+// Reads every wall in order, the access pattern of Maze::get_image.
+// @return number of open walls.
+template <typename Walls>
+size_t ScanWalls(const Walls& walls, const size_t& size) {
+  size_t open = 0;
+  for(size_t i = 0; i < size; ++i) {
+    open += !walls.HasRightWall(i);
+    open += !walls.HasBottomWall(i);
+  }
+  return open;
+}
+
+// Times allocation, a generation-like pass of wall breaks, a solve-like
+// traversal and a render-like scan for one wall layout of the maze.
+template <typename Walls>
+void BenchmarkLayout(const char* name, const Maze& maze) {
+  const size_t size = maze.size();
+  long baseline = ResetPeakResident();
+  auto start = chrono::steady_clock::now();
+  Walls walls(size);
+  double allocate_seconds = SecondsSince(start);
+  double megabytes = (PeakResidentKilobytes() - baseline) / 1024.0;
+
+  start = chrono::steady_clock::now();
+  for(size_t i = 0; i < size; ++i) {
+    if(!maze.HasRightWall(i)) walls.Break(i, 0);
+    if(!maze.HasBottomWall(i)) walls.Break(i, 1);
+  }
+  double break_seconds = SecondsSince(start);
+
+  start = chrono::steady_clock::now();
+  size_t reached = TraverseWalls(walls, maze.num_rows(), maze.num_columns());
+  double solve_seconds = SecondsSince(start);
+
+  start = chrono::steady_clock::now();
+  size_t open = ScanWalls(walls, size);
+  double scan_seconds = SecondsSince(start);
+
+  printf("%-12s %-10.2f %-10.4f %-10.4f %-10.4f %-10.4f %s\n", name, megabytes,
+         allocate_seconds, break_seconds, solve_seconds, scan_seconds,
+         reached == size && open == size - 1 ? "" : "MISMATCH");
+}
+
+// Compares LegacyWalls with WallStore on a generated maze of about max_cells
+// cells. Each layout runs in a forked child to isolate its memory.
+void BenchmarkWallLayouts(const size_t& max_cells) {
+  size_t side = 1;
+  while((side+1)*(side+1) <= max_cells) {
+    ++side;
+  }
+  Maze maze(side, side);
+  maze.Generate(1, 1);
+  printf("%-12s %-10s %-10s %-10s %-10s %-10s\n", "layout", "MB", "allocate",
+         "break", "solve", "render");
+  for(int layout = 0; layout < 2; ++layout) {
+    fflush(stdout);
+    pid_t child = fork();
+    if(child == 0) {
+      if(layout == 0) {
+        BenchmarkLayout<LegacyWalls>("vector<bool>", maze);
+      } else {
+        BenchmarkLayout<WallStore>("WallStore", maze);
+      }
+      fflush(stdout);
+      _exit(0);
+    }
+    waitpid(child, nullptr, 0);
+  }
+}
+
+// Runs the Kruskal workload of Maze::Generate on a side*side grid with one
+// BasicDisjSets configuration.
+// @return seconds taken.
+template <typename Sets>
+double TimeKruskal(const size_t& side) {
+  const size_t size = side*side;
+  Sets sets(size);
+  FeistelPermutation permutation(2*size, 1);
+  size_t unions_left = size - 1;
+  size_t wall_id, cell, neighbor;
+  auto start = chrono::steady_clock::now();
+  for(size_t i = 0; i < permutation.size() && unions_left > 0; ++i) {
+    wall_id = permutation(i);
+    cell = wall_id / 2;
+    if(wall_id % 2 == 0 ? cell % side == side - 1 : cell / side == side - 1) {
+      continue;
+    }
+    neighbor = wall_id % 2 == 0 ? cell + 1 : cell + side;
+    auto root = sets.Find(cell);
+    auto neighbor_root = sets.Find(neighbor);
+    if(root != neighbor_root) {
+      sets.UnionSets(root, neighbor_root);
+      --unions_left;
+    }
+  }
+  return SecondsSince(start);
+}
+
+template <typename Index>
+void BenchmarkDisjSetsIndex(const char* index_name, const size_t& side) {
+  printf("%-10s %-16s %-12.4f %-12.4f\n", index_name, "compression",
+         TimeKruskal<BasicDisjSets<Index, FullCompression, UnionByRank>>(side),
+         TimeKruskal<BasicDisjSets<Index, FullCompression, UnionBySize>>(side));
+  printf("%-10s %-16s %-12.4f %-12.4f\n", index_name, "halving",
+         TimeKruskal<BasicDisjSets<Index, PathHalving, UnionByRank>>(side),
+         TimeKruskal<BasicDisjSets<Index, PathHalving, UnionBySize>>(side));
+  printf("%-10s %-16s %-12.4f %-12.4f\n", index_name, "splitting",
+         TimeKruskal<BasicDisjSets<Index, PathSplitting, UnionByRank>>(side),
+         TimeKruskal<BasicDisjSets<Index, PathSplitting, UnionBySize>>(side));
+}
+
+// Times every index width, find policy and union policy of BasicDisjSets on
+// the Kruskal workload for 10^6, 10^7, ... cells up to max_cells.
+void BenchmarkDisjSets(const size_t& max_cells) {
+  for(size_t cells = 1000000; cells <= max_cells; cells *= 10) {
+    size_t side = 1;
+    while((side+1)*(side+1) <= cells) {
+      ++side;
+    }
+    printf("%zu cells, seconds\n", side*side);
+    printf("%-10s %-16s %-12s %-12s\n", "index", "find", "by rank", "by size");
+    if(side*side < (1ULL << 32)) {
+      BenchmarkDisjSetsIndex<uint32_t>("uint32", side);
+    }
+    BenchmarkDisjSetsIndex<uint64_t>("uint64", side);
+  }
+}
+
+// Pans a viewport of about max_cells cells, capped at 10^6, across an
+// InfiniteMaze in steps of a tenth of its side. The first window generates
+// every tile it overlaps, later ones only the tiles scrolling into view.
+void BenchmarkInfiniteWindows(const size_t& max_cells, const size_t& tile_size) {
+  size_t side = 1;
+  while((side+1)*(side+1) <= min(max_cells, (size_t)1000000)) {
+    ++side;
+  }
+  const size_t tiles_across = (side + tile_size - 1) / tile_size + 1;
+  InfiniteMaze maze(tile_size, 1, 2*tiles_across*tiles_across);
+  printf("%-12s %-12s %-12s %-12s\n", "window", "seconds", "cells/sec", "new tiles");
+  int64_t origin = 1LL << 40; // far from the tile at (0,0)
+  size_t tiles_before;
+  for(size_t step = 0; step <= 10; ++step) {
+    tiles_before = maze.tiles_generated();
+    auto start = chrono::steady_clock::now();
+    Maze window = maze.GetWindow(origin, origin + (int64_t)(step*side/10), side, side);
+    double seconds = SecondsSince(start);
+    printf("%-12zu %-12.4f %-12.0f %-12zu\n", step, seconds, window.size()/seconds,
+           maze.tiles_generated() - tiles_before);
+  }
+}
+
+// Maze::Solve before BfsSolver, an unordered_map of parents, a std::set of
+// visited cells and a std::queue. Kept as the baseline of BenchmarkSolve.
+forward_list<size_t> LegacySolve(const Maze& maze, const size_t& start,
+                                 const size_t& end) {
+  const size_t columns = maze.num_columns();
+  forward_list<size_t> result;
+  unordered_map<size_t, size_t> cell_to_previous;
+  set<size_t> visited;
+  queue<size_t> cells_to_visit;
+  cell_to_previous[start] = start;
+  cells_to_visit.push(start);
+  size_t current_cell;
+  while(!cells_to_visit.empty()) {
+    current_cell = cells_to_visit.front();
+    visited.insert(current_cell);
+    cells_to_visit.pop();
+    if(current_cell == end) {
+      while(current_cell != start) {
+        result.push_front(current_cell);
+        current_cell = cell_to_previous[current_cell];
+      }
+      result.push_front(current_cell);
+      return result;
+    }
+    if(visited.find(current_cell-1) == visited.end() && current_cell % columns != 0
+       && !maze.HasRightWall(current_cell-1)) {
+      cells_to_visit.push(current_cell-1);
+      cell_to_previous[current_cell-1] = current_cell;
+    }
+    if(visited.find(current_cell-columns) == visited.end() && current_cell >= columns
+       && !maze.HasBottomWall(current_cell-columns)) {
+      cells_to_visit.push(current_cell-columns);
+      cell_to_previous[current_cell-columns] = current_cell;
+    }
+    if(visited.find(current_cell+1) == visited.end() && !maze.HasRightWall(current_cell)) {
+      cells_to_visit.push(current_cell+1);
+      cell_to_previous[current_cell+1] = current_cell;
+    }
+    if(visited.find(current_cell+columns) == visited.end()
+       && !maze.HasBottomWall(current_cell)) {
+      cells_to_visit.push(current_cell+columns);
+      cell_to_previous[current_cell+columns] = current_cell;
+    }
+  }
+  return result;
+}
+
+// Solves square mazes of 10^4, 10^5, ... cells up to max_cells from the top
+// left to the bottom right cell. The legacy solver is skipped above 10^7
+// cells, where its maps need tens of GB. "reused" is a second Solve on the
+// same BfsSolver, which allocates nothing.
+void BenchmarkSolve(const size_t& max_cells) {
+  printf("%-12s %-12s %-12s %-12s %-10s %-10s\n", "cells", "legacy", "BfsSolver",
+         "reused", "speedup", "path");
+  for(size_t cells = 10000; cells <= max_cells; cells *= 10) {
+    size_t side = 1;
+    while((side+1)*(side+1) <= cells) {
+      ++side;
+    }
+    Maze maze(side, side);
+    maze.Generate(1, 1);
+    const size_t end = maze.size() - 1;
+    double legacy_seconds = 0;
+    size_t legacy_length = 0;
+    auto start = chrono::steady_clock::now();
+    if(cells <= 10000000) {
+      forward_list<size_t> legacy = LegacySolve(maze, 0, end);
+      legacy_seconds = SecondsSince(start);
+      legacy_length = distance(legacy.begin(), legacy.end());
+    }
+    BfsSolver solver;
+    vector<size_t> path;
+    start = chrono::steady_clock::now();
+    solver.Solve(maze, 0, end, &path);
+    double first_seconds = SecondsSince(start);
+    start = chrono::steady_clock::now();
+    solver.Solve(maze, 0, end, &path);
+    double reused_seconds = SecondsSince(start);
+    if(legacy_seconds > 0) {
+      printf("%-12zu %-12.4f %-12.4f %-12.4f %-10.1f %zu%s\n", maze.size(),
+             legacy_seconds, first_seconds, reused_seconds,
+             legacy_seconds/reused_seconds, path.size(),
+             legacy_length == path.size() ? "" : " MISMATCH");
+    } else {
+      printf("%-12zu %-12s %-12.4f %-12.4f %-10s %zu\n", maze.size(), "-",
+             first_seconds, reused_seconds, "-", path.size());
+    }
+  }
+}
+
+// Answers random start/end queries on one maze of about max_cells cells,
+// with a BfsSolver per query and with a MazeTree built once.
+void BenchmarkTree(const size_t& max_cells) {
+  size_t side = 1;
+  while((side+1)*(side+1) <= max_cells) {
+    ++side;
+  }
+  Maze maze(side, side);
+  maze.Generate(1, 1);
+  CounterRng gen(2);
+  vector<size_t> path;
+  size_t moves = 0;
+  printf("%-24s %-12s %-12s %-12s\n", "query", "queries", "seconds", "queries/sec");
+
+  BfsSolver solver;
+  const size_t bfs_queries = 100;
+  auto start = chrono::steady_clock::now();
+  for(size_t q = 0; q < bfs_queries; ++q) {
+    solver.Solve(maze, gen.Below(maze.size()), gen.Below(maze.size()), &path);
+  }
+  double seconds = SecondsSince(start);
+  printf("%-24s %-12zu %-12.4f %-12.0f\n", "BfsSolver::Solve", bfs_queries,
+         seconds, bfs_queries/seconds);
+
+  start = chrono::steady_clock::now();
+  MazeTree tree(maze);
+  seconds = SecondsSince(start);
+  printf("%-24s %-12s %-12.4f\n", "MazeTree(maze)", "-", seconds);
+
+  const size_t length_queries = 1000000;
+  start = chrono::steady_clock::now();
+  for(size_t q = 0; q < length_queries; ++q) {
+    moves += tree.PathLength(gen.Below(maze.size()), gen.Below(maze.size()));
+  }
+  seconds = SecondsSince(start);
+  printf("%-24s %-12zu %-12.4f %-12.0f\n", "MazeTree::PathLength", length_queries,
+         seconds, length_queries/seconds);
+
+  const size_t path_queries = 10000;
+  size_t path_cells = 0;
+  start = chrono::steady_clock::now();
+  for(size_t q = 0; q < path_queries; ++q) {
+    tree.Path(gen.Below(maze.size()), gen.Below(maze.size()), &path);
+    path_cells += path.size();
+  }
+  seconds = SecondsSince(start);
+  printf("%-24s %-12zu %-12.4f %-12.0f (%.0f cells/path)\n", "MazeTree::Path",
+         path_queries, seconds, path_queries/seconds, (double)path_cells/path_queries);
+  if(moves == 0 && max_cells > 1) {
+    printf("MISMATCH\n");
+  }
+}
+
+// Solves the same random queries on a maze of about max_cells cells with
+// Maze::SolveBatch on 1, 2, 4, ... threads up to max_threads.
+void BenchmarkSolveBatch(const size_t& max_cells, const size_t& max_threads) {
+  size_t side = 1;
+  while((side+1)*(side+1) <= max_cells) {
+    ++side;
+  }
+  Maze maze(side, side);
+  maze.Generate(1, 1);
+  CounterRng gen(3);
+  vector<pair<size_t, size_t>> queries(200);
+  for(auto& query: queries) {
+    query = pair<size_t, size_t>(gen.Below(maze.size()), gen.Below(maze.size()));
+  }
+  vector<size_t> lengths;
+  printf("%-12s %-12s %-12s %-10s\n", "threads", "seconds", "queries/sec", "speedup");
+  double single_thread_seconds = 0;
+  for(size_t threads = 1; threads <= max_threads; threads *= 2) {
+    auto start = chrono::steady_clock::now();
+    maze.SolveBatch(queries, threads, &lengths);
+    double seconds = SecondsSince(start);
+    if(threads == 1) {
+      single_thread_seconds = seconds;
+    }
+    printf("%-12zu %-12.4f %-12.0f %-10.2f\n", threads, seconds,
+           queries.size()/seconds, single_thread_seconds/seconds);
+  }
+}
+
+// Solves the same random queries with every MazeSolver on mazes of about
+// max_cells cells braided with fractions 0, 0.5 and 1, and prints the mean
+// number of cells expanded per query.
+void BenchmarkSolvers(const size_t& max_cells) {
+  size_t side = 1;
+  while((side+1)*(side+1) <= max_cells) {
+    ++side;
+  }
+  const size_t query_count = 100;
+  printf("%-8s %-14s %-12s %-14s %-10s\n", "braid", "solver", "seconds",
+         "expanded/query", "vs bfs");
+  for(double fraction: {0.0, 0.5, 1.0}) {
+    Maze maze(side, side);
+    maze.Generate(1, 1);
+    maze.Braid(fraction, 2);
+    vector<size_t> bfs_lengths(query_count);
+    double bfs_expanded = 0;
+    vector<size_t> path;
+    for(const auto& name: SolverNames()) {
+      unique_ptr<MazeSolver> solver = MakeSolver(name);
+      CounterRng gen(4);
+      size_t expanded = 0;
+      bool mismatch = false;
+      auto start = chrono::steady_clock::now();
+      for(size_t q = 0; q < query_count; ++q) {
+        solver->Solve(maze, gen.Below(maze.size()), gen.Below(maze.size()), &path);
+        expanded += solver->expanded();
+        if(name == "bfs") {
+          bfs_lengths[q] = path.size();
+        } else {
+          mismatch |= bfs_lengths[q] != path.size();
+        }
+      }
+      double seconds = SecondsSince(start);
+      if(name == "bfs") {
+        bfs_expanded = expanded;
+      }
+      printf("%-8.1f %-14s %-12.4f %-14.0f %-10.2f%s\n", fraction, name.c_str(),
+             seconds, (double)expanded/query_count, expanded/bfs_expanded,
+             mismatch ? " MISMATCH" : "");
+    }
+  }
+}
+
+// Times Maze::Analyze against Maze::Generate on square mazes of 10^4,
+// 10^5, ... cells up to max_cells.
+void BenchmarkAnalyze(const size_t& max_cells) {
+  printf("%-12s %-12s %-12s %-10s %-10s\n", "cells", "generate", "analyze",
+         "ratio", "diameter");
+  for(size_t cells = 10000; cells <= max_cells; cells *= 10) {
+    size_t side = 1;
+    while((side+1)*(side+1) <= cells) {
+      ++side;
+    }
+    Maze maze(side, side);
+    auto start = chrono::steady_clock::now();
+    maze.Generate(1, 1);
+    double generate_seconds = SecondsSince(start);
+    start = chrono::steady_clock::now();
+    MazeStats stats = maze.Analyze(0, maze.size() - 1);
+    double analyze_seconds = SecondsSince(start);
+    printf("%-12zu %-12.4f %-12.4f %-10.2f %zu\n", maze.size(), generate_seconds,
+           analyze_seconds, analyze_seconds/generate_seconds, stats.diameter);
+  }
+}
+
+// Solves corner to corner with BfsSolver and BitParallelSolver on a maze
+// of about max_cells cells, perfect, fully braided and with every interior
+// wall open. The denser the frontier, the more cells share a word.
+void BenchmarkBitParallel(const size_t& max_cells) {
+  size_t side = 1;
+  while((side+1)*(side+1) <= max_cells) {
+    ++side;
+  }
+  printf("%-12s %-12s %-12s %-10s\n", "maze", "bfs", "bitparallel", "speedup");
+  for(int kind = 0; kind < 3; ++kind) {
+    Maze maze(side, side);
+    maze.Generate(1, 1);
+    if(kind == 1) {
+      maze.Braid(1, 2);
+    } else if(kind == 2) {
+      for(size_t i = 0; i < maze.size(); ++i) {
+        if(i % side != side - 1) maze.OpenWall(i, 0);
+        if(i / side != side - 1) maze.OpenWall(i, 1);
+      }
+    }
+    BfsSolver bfs;
+    BitParallelSolver bit_parallel;
+    vector<size_t> bfs_path, path;
+    bfs.Solve(maze, 0, maze.size() - 1, &bfs_path);
+    auto start = chrono::steady_clock::now();
+    bfs.Solve(maze, 0, maze.size() - 1, &bfs_path);
+    double bfs_seconds = SecondsSince(start);
+    start = chrono::steady_clock::now();
+    bit_parallel.Solve(maze, 0, maze.size() - 1, &path);
+    double seconds = SecondsSince(start);
+    printf("%-12s %-12.4f %-12.4f %-10.2f%s\n",
+           kind == 0 ? "perfect" : kind == 1 ? "braided" : "open",
+           bfs_seconds, seconds, bfs_seconds/seconds,
+           path.size() == bfs_path.size() ? "" : " MISMATCH");
+  }
+}
+
+// Computes the distance field from cell 0 of a maze of about max_cells
+// cells, perfect, fully braided and with every interior wall open, on 1,
+// 2, 4, ... threads up to max_threads. BfsSolver from corner to corner,
+// which visits nearly every cell, is the single thread baseline.
+void BenchmarkDistanceField(const size_t& max_cells, const size_t& max_threads) {
+  size_t side = 1;
+  while((side+1)*(side+1) <= max_cells) {
+    ++side;
+  }
+  printf("%-8s %-12s %-12s %-14s %-10s\n", "maze", "threads", "seconds",
+         "cells/sec", "vs bfs");
+  for(int kind = 0; kind < 3; ++kind) {
+    Maze maze(side, side);
+    maze.Generate(1, 1);
+    if(kind == 1) {
+      maze.Braid(1, 2);
+    } else if(kind == 2) {
+      for(size_t i = 0; i < maze.size(); ++i) {
+        if(i % side != side - 1) maze.OpenWall(i, 0);
+        if(i / side != side - 1) maze.OpenWall(i, 1);
+      }
+    }
+    const char* name = kind == 0 ? "perfect" : kind == 1 ? "braided" : "open";
+    BfsSolver bfs;
+    vector<size_t> path;
+    bfs.Solve(maze, 0, maze.size() - 1, &path);
+    auto start = chrono::steady_clock::now();
+    bfs.Solve(maze, 0, maze.size() - 1, &path);
+    double bfs_seconds = SecondsSince(start);
+    printf("%-8s %-12s %-12.4f %-14.0f %-10.2f\n", name, "bfs", bfs_seconds,
+           maze.size()/bfs_seconds, 1.0);
+    vector<uint32_t> distance;
+    for(size_t threads = 1; threads <= max_threads; threads *= 2) {
+      start = chrono::steady_clock::now();
+      ComputeDistanceField(maze, 0, threads, &distance);
+      double seconds = SecondsSince(start);
+      printf("%-8s %-12zu %-12.4f %-14.0f %-10.2f%s\n", name, threads, seconds,
+             maze.size()/seconds, bfs_seconds/seconds,
+             distance[maze.size() - 1] + 1 == path.size() ? "" : " MISMATCH");
+    }
+  }
+}
+
+// Solves corner to corner a backtracker maze of about max_cells cells,
+// whose paths wind through a large share of the cells, into a
+// forward_list and into a PackedPath, then walks and writes the packed
+// path. A list node is counted as 32 bytes, its cell and link plus the
+// allocator's header.
+void BenchmarkPackedPath(const size_t& max_cells) {
+  size_t side = 1;
+  while((side+1)*(side+1) <= max_cells) {
+    ++side;
+  }
+  Maze maze(side, side);
+  unique_ptr<MazeGenerator> generator = MakeGenerator("backtracker", MazeOptions());
+  maze.Generate(generator.get(), 1);
+  const size_t end = maze.size() - 1;
+
+  auto start = chrono::steady_clock::now();
+  forward_list<size_t> list = maze.Solve(0, end);
+  double list_seconds = SecondsSince(start);
+  const size_t list_cells = distance(list.begin(), list.end());
+  start = chrono::steady_clock::now();
+  list.clear();
+  double list_free_seconds = SecondsSince(start);
+
+  PackedPath path;
+  start = chrono::steady_clock::now();
+  maze.Solve(0, end, &path);
+  double packed_seconds = SecondsSince(start);
+  start = chrono::steady_clock::now();
+  size_t checksum = 0;
+  for(const auto& cell: path) {
+    checksum += cell;
+  }
+  double walk_seconds = SecondsSince(start);
+  const string filename = "maze_benchmark_path.tmp";
+  start = chrono::steady_clock::now();
+  WritePath(filename, path);
+  double write_seconds = SecondsSince(start);
+  PackedPath read;
+  ReadPath(filename, &read);
+  remove(filename.c_str());
+
+  printf("%-14s %-12s %-12s %-12s\n", "result", "cells", "seconds", "MB");
+  printf("%-14s %-12zu %-12.4f %-12.3f\n", "forward_list", list_cells,
+         list_seconds + list_free_seconds, 32.0*list_cells/1e6);
+  printf("%-14s %-12zu %-12.4f %-12.3f%s\n", "PackedPath", path.size(),
+         packed_seconds, path.bytes()/1e6,
+         path.size() == list_cells && checksum > 0 ? "" : " MISMATCH");
+  printf("%-14s %-12zu %-12.4f\n", "  iterate", path.size(), walk_seconds);
+  printf("%-14s %-12zu %-12.4f %-12s%s\n", "  WritePath", path.size(),
+         write_seconds, "-", read.words() == path.words() ? "" : " MISMATCH");
+}
+
+// Image with the 4 byte pixels of the old int** Image.
+typedef BasicImage<int> IntImage;
+
+// Sets a scale*scale square of image through SetPixel, as Maze did before
+// ScanlineRenderer.
+void LegacySetScaledPixel(const size_t& i, const size_t& j, const size_t& scale,
+                          IntImage* image, const unsigned int& value) {
+  for(size_t x = i; x < i + scale; ++x) {
+    for(size_t y = j; y < j + scale; ++y) {
+      image->SetPixel(x, y, value);
+    }
+  }
+}
+
+// Maze::get_image before ScanlineRenderer: a filled image with every cell
+// and open wall painted over it pixel by pixel, 4 bytes per pixel. Kept as
+// the baseline of BenchmarkRender.
+IntImage LegacyGetImage(const Maze& maze, const size_t& scale) {
+  IntImage image;
+  const size_t columns = maze.num_columns();
+  image.AllocateSpaceAndSetSize(scale*((2*maze.num_rows())+1),
+                                scale*((2*columns)+1));
+  image.SetNumberGrayLevels(255);
+  for(size_t i = 0; i < image.num_rows(); ++i) {
+    for(size_t j = 0; j < image.num_columns(); ++j) {
+      image.SetPixel(i, j, 130);
+    }
+  }
+  LegacySetScaledPixel(0, scale, scale, &image, 255);
+  LegacySetScaledPixel(image.num_rows()-scale, image.num_columns()-(2*scale),
+                       scale, &image, 255);
+  for(size_t i = scale; i < image.num_rows(); i += 2*scale) {
+    for(size_t j = scale; j < image.num_columns(); j += 2*scale) {
+      LegacySetScaledPixel(i, j, scale, &image, 255);
+    }
+  }
+  for(size_t i = 0; i < maze.size(); ++i) {
+    const size_t row = scale*((2*(i/columns))+1);
+    const size_t col = scale*((2*(i%columns))+1);
+    if(!maze.HasRightWall(i)) {
+      LegacySetScaledPixel(row, col+scale, scale, &image, 255);
+    }
+    if(!maze.HasBottomWall(i)) {
+      LegacySetScaledPixel(row+scale, col, scale, &image, 255);
+    }
+  }
+  return image;
+}
+
+// Renders square mazes with LegacyGetImage and Maze::get_image at scales 1,
+// 4 and 15, each maze sized so the image has about 4*max_cells pixels.
+void BenchmarkRender(const size_t& max_cells) {
+  printf("%-8s %-12s %-14s %-14s %-10s %-10s\n", "scale", "cells",
+         "legacy MPix/s", "get_image", "speedup", "MB");
+  // Freed images stay in the heap, so the runs after the first measure
+  // rendering rather than page faults.
+  mallopt(M_MMAP_THRESHOLD, 1 << 30);
+  mallopt(M_TRIM_THRESHOLD, 1 << 30);
+  for(size_t scale: {1, 4, 15}) {
+    size_t side = 1;
+    while((2*(side+1)+1)*scale*(2*(side+1)+1)*scale <= 4*max_cells) {
+      ++side;
+    }
+    Maze maze(side, side);
+    maze.Generate(1, 1);
+    // best of three.
+    double legacy_seconds = 1e30, seconds = 1e30;
+    IntImage legacy;
+    Image image;
+    for(int run = 0; run < 3; ++run) {
+      legacy = IntImage();
+      image = Image();
+      auto start = chrono::steady_clock::now();
+      legacy = LegacyGetImage(maze, scale);
+      legacy_seconds = min(legacy_seconds, SecondsSince(start));
+      start = chrono::steady_clock::now();
+      image = maze.get_image(scale);
+      seconds = min(seconds, SecondsSince(start));
+    }
+    const double pixels = image.size();
+    bool same = legacy.size() == image.size();
+    for(size_t i = 0; i < image.size() && same; ++i) {
+      same = legacy.data()[i] == image.data()[i];
+    }
+    printf("%-8zu %-12zu %-14.1f %-14.1f %-10.2f %-10.1f%s\n", scale, maze.size(),
+           pixels/legacy_seconds/1e6, pixels/seconds/1e6, legacy_seconds/seconds,
+           image.size()/1e6, same ? "" : " MISMATCH");
+  }
+  mallopt(M_MMAP_THRESHOLD, 128*1024);
+  mallopt(M_TRIM_THRESHOLD, 128*1024);
+}
+
+// Writes the unsolved and solved images of a square maze of about
+// max_cells cells at scales 1 and 10, once through get_image and
+// get_solved_image and WriteImage and once through WriteMazeImage. Each
+// run happens in a forked child, so peak memory is the run's own.
+void BenchmarkWriteImage(const size_t& max_cells) {
+  const string filename = "/tmp/maze_benchmark.pgm";
+  size_t side = 1;
+  while((side+1)*(side+1) <= max_cells) {
+    ++side;
+  }
+  Maze maze(side, side);
+  maze.Generate(1, 1);
+  printf("%-8s %-16s %-12s %-12s %-10s\n", "scale", "writer", "unsolved s",
+         "solved s", "peak MB");
+  for(size_t scale: {1, 10}) {
+    for(const bool streamed: {false, true}) {
+      fflush(stdout);
+      pid_t child = fork();
+      if(child == 0) {
+        long baseline = ResetPeakResident();
+        auto start = chrono::steady_clock::now();
+        bool ok;
+        if(streamed) {
+          ScanlineRenderer renderer(maze, scale);
+          ok = WriteMazeImage(filename, &renderer);
+        } else {
+          ok = WriteImage(filename, maze.get_image(scale));
+        }
+        const double unsolved_seconds = SecondsSince(start);
+        start = chrono::steady_clock::now();
+        if(streamed) {
+          PackedPath path;
+          maze.Solve(0, maze.size() - 1, &path);
+          ScanlineRenderer renderer(maze, scale);
+          renderer.SetSolution(path, 0, maze.size() - 1);
+          ok = WriteMazeImage(filename, &renderer) && ok;
+        } else {
+          ok = WriteImage(filename, maze.get_solved_image(0, 0, side - 1,
+                                                          side - 1, scale)) && ok;
+        }
+        printf("%-8zu %-16s %-12.4f %-12.4f %-10.1f%s\n", scale,
+               streamed ? "WriteMazeImage" : "WriteImage", unsolved_seconds,
+               SecondsSince(start), (PeakResidentKilobytes() - baseline)/1024.0,
+               ok ? "" : " FAILED");
+        fflush(stdout);
+        _exit(0);
+      }
+      waitpid(child, nullptr, 0);
+    }
+  }
+  remove(filename.c_str());
+}
+
+// Writes the image of a square maze of about max_cells cells at scale 10
+// with the streaming WriteMazeImage and the banded one on 1 to max_threads
+// threads, doubling.
+void BenchmarkWriteBands(const size_t& max_cells, const size_t& max_threads) {
+  const string filename = "/tmp/maze_benchmark.pgm";
+  size_t side = 1;
+  while((side+1)*(side+1) <= max_cells) {
+    ++side;
+  }
+  Maze maze(side, side);
+  maze.Generate(1, 1);
+  ScanlineRenderer renderer(maze, 10);
+  const double megabytes = renderer.width()*renderer.height()/1e6;
+  printf("%-10s %-12s %-12s\n", "threads", "seconds", "MB/s");
+  // the file is removed before each run, so no run pays for truncating
+  // the one before it.
+  remove(filename.c_str());
+  auto start = chrono::steady_clock::now();
+  WriteMazeImage(filename, &renderer);
+  double seconds = SecondsSince(start);
+  printf("%-10s %-12.4f %-12.1f\n", "stream", seconds, megabytes/seconds);
+  for(size_t threads = 1; threads <= max_threads; threads *= 2) {
+    remove(filename.c_str());
+    start = chrono::steady_clock::now();
+    WriteMazeImage(filename, renderer, threads);
+    seconds = SecondsSince(start);
+    printf("%-10zu %-12.4f %-12.1f\n", threads, seconds, megabytes/seconds);
+  }
+  remove(filename.c_str());
+}
+
+// Builds 16 solved images of random queries on a maze of about max_cells
+// cells at scale 4, once with get_solved_image per query and once with a
+// single get_image and a PathOverlay drawn and cleared per query. Paths are
+// solved beforehand, so only the drawing is timed.
+void BenchmarkOverlay(const size_t& max_cells) {
+  size_t side = 1;
+  while((side+1)*(side+1) <= max_cells) {
+    ++side;
+  }
+  Maze maze(side, side);
+  maze.Generate(1, 1);
+  CounterRng gen(5);
+  vector<PackedPath> paths(16);
+  for(auto& path: paths) {
+    maze.Solve(gen.Below(maze.size()), gen.Below(maze.size()), &path);
+  }
+  const size_t scale = 4;
+  size_t checksum = 0;
+  auto start = chrono::steady_clock::now();
+  for(const auto& path: paths) {
+    Image solved = maze.get_solved_image(path, scale);
+    checksum += solved.data()[solved.size() / 2];
+  }
+  const double render_seconds = SecondsSince(start);
+  start = chrono::steady_clock::now();
+  Image image = maze.get_image(scale);
+  PathOverlay overlay(maze, scale, &image);
+  for(const auto& path: paths) {
+    overlay.DrawPath(path);
+    checksum -= image.data()[image.size() / 2];
+    overlay.Clear();
+  }
+  const double overlay_seconds = SecondsSince(start);
+  printf("%-12s %-14s %-14s %-10s\n", "cells", "render each s", "overlay s",
+         "speedup");
+  printf("%-12zu %-14.4f %-14.4f %-10.2f%s\n", maze.size(), render_seconds,
+         overlay_seconds, render_seconds/overlay_seconds,
+         checksum == 0 ? "" : " MISMATCH");
+}
+
+// Writes the unsolved and solved images of a square maze of about
+// max_cells cells at scale 10 in every MazeImageFormat, and prints the
+// seconds and size of each file.
+void BenchmarkFormats(const size_t& max_cells) {
+  const string filename = "/tmp/maze_benchmark.img";
+  size_t side = 1;
+  while((side+1)*(side+1) <= max_cells) {
+    ++side;
+  }
+  Maze maze(side, side);
+  maze.Generate(1, 1);
+  PackedPath path;
+  maze.Solve(0, maze.size() - 1, &path);
+  const pair<const char*, MazeImageFormat> formats[] = {
+      {"pgm", MazeImageFormat::kPgm}, {"pbm", MazeImageFormat::kPbm},
+      {"bmp", MazeImageFormat::kBmp}};
+  printf("%-10s %-8s %-12s %-10s\n", "image", "format", "seconds", "MB");
+  for(const bool solved: {false, true}) {
+    for(const auto& format: formats) {
+      if(!solved && format.second == MazeImageFormat::kBmp) {
+        continue;
+      }
+      if(solved && format.second == MazeImageFormat::kPbm) {
+        continue;
+      }
+      ScanlineRenderer renderer(maze, 10);
+      if(solved) {
+        renderer.SetSolution(path, 0, maze.size() - 1);
+      }
+      remove(filename.c_str());
+      auto start = chrono::steady_clock::now();
+      WriteMazeImage(filename, &renderer, format.second);
+      const double seconds = SecondsSince(start);
+      FILE* file = fopen(filename.c_str(), "rb");
+      long bytes = 0;
+      if(file != nullptr) {
+        fseek(file, 0, SEEK_END);
+        bytes = ftell(file);
+        fclose(file);
+      }
+      printf("%-10s %-8s %-12.4f %-10.1f\n", solved ? "solved" : "unsolved",
+             format.first, seconds, bytes/1e6);
+    }
+  }
+  remove(filename.c_str());
+}
+
+// Writes the solved image of a square maze of about max_cells cells at
+// scale 10 as png at zlib levels 1 and 6 on 1 to max_threads threads,
+// doubling, against WriteMazeImage's pgm.
+void BenchmarkPng(const size_t& max_cells, const size_t& max_threads) {
+  const string filename = "/tmp/maze_benchmark.img";
+  size_t side = 1;
+  while((side+1)*(side+1) <= max_cells) {
+    ++side;
+  }
+  Maze maze(side, side);
+  maze.Generate(1, 1);
+  PackedPath path;
+  maze.Solve(0, maze.size() - 1, &path);
+  ScanlineRenderer renderer(maze, 10);
+  renderer.SetSolution(path, 0, maze.size() - 1);
+  auto file_megabytes = [&]() {
+    FILE* file = fopen(filename.c_str(), "rb");
+    long bytes = 0;
+    if(file != nullptr) {
+      fseek(file, 0, SEEK_END);
+      bytes = ftell(file);
+      fclose(file);
+    }
+    return bytes/1e6;
+  };
+  printf("%-8s %-8s %-10s %-12s %-10s\n", "format", "level", "threads",
+         "seconds", "MB");
+  remove(filename.c_str());
+  auto start = chrono::steady_clock::now();
+  WriteMazeImage(filename, &renderer);
+  printf("%-8s %-8s %-10s %-12.4f %-10.2f\n", "pgm", "-", "1",
+         SecondsSince(start), file_megabytes());
+  for(const int level: {1, 6}) {
+    for(size_t threads = 1; threads <= max_threads; threads *= 2) {
+      remove(filename.c_str());
+      start = chrono::steady_clock::now();
+      PngWriter writer(threads, level);
+      vector<unsigned char> scanline(renderer.width());
+      bool ok = writer.Open(filename, renderer.height(), renderer.width());
+      for(size_t unit_row = 0; ok && unit_row < renderer.unit_height(); ++unit_row) {
+        renderer.Render(unit_row, scanline.data());
+        for(size_t i = 0; ok && i < renderer.scale(); ++i) {
+          ok = writer.WriteRow(scanline.data());
+        }
+      }
+      ok = writer.Close() && ok;
+      printf("%-8s %-8d %-10zu %-12.4f %-10.2f%s\n", "png", level, threads,
+             SecondsSince(start), file_megabytes(), ok ? "" : " FAILED");
+    }
+  }
+  remove(filename.c_str());
+}
+
+}  // namespace
+
+// ./maze_benchmark [max_cells] [max_threads]
+// max_cells defaults to 10^6, pass 100000000 for the full 10^8 sweep.
+// max_threads defaults to the number of hardware threads.
+int main(int argc, char **argv) {
+  size_t max_cells = 1000000;
+  size_t max_threads = max(1u, thread::hardware_concurrency());
+  if (argc > 3 || (argc > 1 && !IsUnsignedNumber(argv[1]))
+      || (argc > 2 && !IsUnsignedNumber(argv[2]))) {
+    printf("ERROR: invalid arguments, usage: ./maze_benchmark [max_cells] [max_threads]\n");
+    return 0;
+  }
+  if (argc > 1) {
+    max_cells = StringToSizeT(argv[1]);
+  }
+  if (argc > 2) {
+    max_threads = max((size_t)1, StringToSizeT(argv[2]));
+  }
+
+  // A fixed mmap threshold keeps glibc from raising it after large frees,
+  // so big buffers are returned to the system and measured again.
+  mallopt(M_MMAP_THRESHOLD, 128*1024);
+  cout << "Maze::Generate" << endl;
+  BenchmarkGenerate(max_cells);
+  cout << endl << "Maze::Generate(threads)" << endl;
+  BenchmarkGenerateThreads(max_cells, max_threads);
+  cout << endl << "Maze::GenerateTiled(256, threads)" << endl;
+  BenchmarkGenerateTiled(max_cells, max_threads, 256);
+  cout << endl << "SampleRandomIndex(threads)" << endl;
+  BenchmarkShuffle(max_cells, max_threads);
+  cout << endl << "BfsSolver::Solve (seconds)" << endl;
+  BenchmarkSolve(max_cells);
+  cout << endl << "Maze::Solve, forward_list against PackedPath" << endl;
+  BenchmarkPackedPath(max_cells);
+  cout << endl << "Maze::get_image" << endl;
+  BenchmarkRender(max_cells);
+  cout << endl << "Writing unsolved and solved images" << endl;
+  BenchmarkWriteImage(max_cells);
+  cout << endl << "WriteMazeImage(threads), scale 10" << endl;
+  BenchmarkWriteBands(max_cells, max_threads);
+  cout << endl << "16 solved images, get_solved_image against PathOverlay" << endl;
+  BenchmarkOverlay(max_cells);
+  cout << endl << "WriteMazeImage formats, scale 10" << endl;
+  BenchmarkFormats(max_cells);
+  cout << endl << "PngWriter(threads, level), solved image at scale 10" << endl;
+  BenchmarkPng(max_cells, max_threads);
+  cout << endl << "Path queries" << endl;
+  BenchmarkTree(max_cells);
+  cout << endl << "Maze::Analyze (seconds)" << endl;
+  BenchmarkAnalyze(max_cells);
+  cout << endl << "MazeSolver on braided mazes" << endl;
+  BenchmarkSolvers(max_cells);
+  cout << endl << "BitParallelSolver, corner to corner (seconds)" << endl;
+  BenchmarkBitParallel(max_cells);
+  cout << endl << "ComputeDistanceField(threads)" << endl;
+  BenchmarkDistanceField(max_cells, max_threads);
+  cout << endl << "Maze::SolveBatch(threads)" << endl;
+  BenchmarkSolveBatch(max_cells, max_threads);
+  cout << endl << "InfiniteMaze::GetWindow, 64 cell tiles" << endl;
+  BenchmarkInfiniteWindows(max_cells, 64);
+  cout << endl << "Maze::Generate(generator)" << endl;
+  BenchmarkGenerators(max_cells);
+  cout << endl << "BasicDisjSets" << endl;
+  BenchmarkDisjSets(max_cells);
+  cout << endl << "Wall layouts (seconds)" << endl;
+  BenchmarkWallLayouts(max_cells);
+  return 0;
+}
@@ -0,0 +1,211 @@
+#include "maze_generator.h"
+using namespace std;
+
+namespace {
+
+// Opens the wall between two neighboring cells a and b.
+void OpenBetween(Maze* maze, const size_t& a, const size_t& b) {
+  // vertical first, with one column a+1 is the cell below.
+  if(b == a + maze->num_columns()) {
+    maze->OpenWall(a, 1);
+  } else if(a == b + maze->num_columns()) {
+    maze->OpenWall(b, 1);
+  } else if(b == a + 1) {
+    maze->OpenWall(a, 0);
+  } else {
+    maze->OpenWall(b, 0);
+  }
+}
+
+// Collects the cells left, above, right and below of cell that exist.
+// @return number of neighbors written to neighbors.
+unsigned int GetNeighbors(const Maze& maze, const size_t& cell,
+                          size_t neighbors[4]) {
+  const size_t columns = maze.num_columns();
+  unsigned int count = 0;
+  if(cell % columns != 0) {
+    neighbors[count++] = cell - 1;
+  }
+  if(cell >= columns) {
+    neighbors[count++] = cell - columns;
+  }
+  if(cell % columns != columns - 1) {
+    neighbors[count++] = cell + 1;
+  }
+  if(cell + columns < maze.size()) {
+    neighbors[count++] = cell + columns;
+  }
+  return count;
+}
+
+}  // namespace
+
+void KruskalGenerator::Generate(Maze* maze, const uint64_t& seed) {
+  if(tile_size_ > 0) {
+    maze->GenerateTiled(tile_size_, num_threads_, seed);
+  } else {
+    maze->Generate(num_threads_, seed);
+  }
+}
+
+void WilsonGenerator::Generate(Maze* maze, const uint64_t& seed) {
+  CounterRng gen(seed);
+  const size_t size = maze->size();
+  vector<char> in_tree(size, false);
+  vector<size_t> next(size); // last step taken out of each cell by the walk
+  size_t neighbors[4];
+  size_t current;
+
+  in_tree[gen.Below(size)] = true;
+  for(size_t start = 0; start < size; ++start) {
+    // Walk until the tree is hit. Overwriting next erases any loop the walk
+    // made, so following next from start gives a loop-erased path.
+    current = start;
+    while(!in_tree[current]) {
+      unsigned int count = GetNeighbors(*maze, current, neighbors);
+      next[current] = neighbors[gen.Below(count)];
+      current = next[current];
+    }
+    current = start;
+    while(!in_tree[current]) {
+      in_tree[current] = true;
+      OpenBetween(maze, current, next[current]);
+      current = next[current];
+    }
+  }
+}
+
+void PrimGenerator::Generate(Maze* maze, const uint64_t& seed) {
+  enum State : char { kOutside, kFrontier, kInside };
+  CounterRng gen(seed);
+  const size_t size = maze->size();
+  vector<char> state(size, kOutside);
+  vector<size_t> frontier;
+  size_t neighbors[4];
+  size_t inside[4];
+  size_t current;
+
+  current = gen.Below(size);
+  state[current] = kInside;
+  while(true) {
+    unsigned int count = GetNeighbors(*maze, current, neighbors);
+    for(unsigned int k = 0; k < count; ++k) {
+      if(state[neighbors[k]] == kOutside) {
+        state[neighbors[k]] = kFrontier;
+        frontier.push_back(neighbors[k]);
+      }
+    }
+    if(frontier.empty()) {
+      return;
+    }
+    // swap a random frontier cell to the back and pop it.
+    size_t pick = gen.Below(frontier.size());
+    current = frontier[pick];
+    frontier[pick] = frontier.back();
+    frontier.pop_back();
+
+    unsigned int inside_count = 0;
+    count = GetNeighbors(*maze, current, neighbors);
+    for(unsigned int k = 0; k < count; ++k) {
+      if(state[neighbors[k]] == kInside) {
+        inside[inside_count++] = neighbors[k];
+      }
+    }
+    OpenBetween(maze, current,
+                inside[gen.Below(inside_count)]);
+    state[current] = kInside;
+  }
+}
+
+void BacktrackerGenerator::Generate(Maze* maze, const uint64_t& seed) {
+  CounterRng gen(seed);
+  vector<char> visited(maze->size(), false);
+  vector<size_t> stack;
+  size_t neighbors[4];
+  size_t unvisited[4];
+
+  stack.push_back(gen.Below(maze->size()));
+  visited[stack.back()] = true;
+  while(!stack.empty()) {
+    unsigned int count = GetNeighbors(*maze, stack.back(), neighbors);
+    unsigned int unvisited_count = 0;
+    for(unsigned int k = 0; k < count; ++k) {
+      if(!visited[neighbors[k]]) {
+        unvisited[unvisited_count++] = neighbors[k];
+      }
+    }
+    if(unvisited_count == 0) {
+      stack.pop_back();
+      continue;
+    }
+    size_t next = unvisited[gen.Below(unvisited_count)];
+    OpenBetween(maze, stack.back(), next);
+    visited[next] = true;
+    stack.push_back(next);
+  }
+}
+
+void BinaryTreeGenerator::Generate(Maze* maze, const uint64_t& seed) {
+  CounterRng gen(seed);
+  const size_t rows = maze->num_rows();
+  const size_t columns = maze->num_columns();
+  for(size_t i = 0; i < maze->size(); ++i) {
+    bool last_row = i / columns == rows - 1;
+    bool last_column = i % columns == columns - 1;
+    if(last_row && last_column) {
+      continue;
+    }
+    if(last_row || (!last_column && gen.Coin())) {
+      maze->OpenWall(i, 0);
+    } else {
+      maze->OpenWall(i, 1);
+    }
+  }
+}
+
+void SidewinderGenerator::Generate(Maze* maze, const uint64_t& seed) {
+  CounterRng gen(seed);
+  const size_t rows = maze->num_rows();
+  const size_t columns = maze->num_columns();
+  size_t run_start;
+  for(size_t row = 0; row < rows; ++row) {
+    run_start = row*columns;
+    for(size_t i = row*columns; i < (row+1)*columns; ++i) {
+      bool last_column = i % columns == columns - 1;
+      if(row == rows - 1) {
+        // the last row is one open corridor that every run drains into.
+        if(!last_column) {
+          maze->OpenWall(i, 0);
+        }
+      } else if(last_column || gen.Coin()) {
+        maze->OpenWall(run_start + gen.Below(i - run_start + 1), 1);
+        run_start = i + 1;
+      } else {
+        maze->OpenWall(i, 0);
+      }
+    }
+  }
+}
+
+unique_ptr<MazeGenerator> MakeGenerator(const string& name,
+                                        const MazeOptions& options) {
+  if(name == "kruskal") {
+    return unique_ptr<MazeGenerator>(
+        new KruskalGenerator(options.num_threads, options.tile_size));
+  } else if(name == "wilson") {
+    return unique_ptr<MazeGenerator>(new WilsonGenerator());
+  } else if(name == "prim") {
+    return unique_ptr<MazeGenerator>(new PrimGenerator());
+  } else if(name == "backtracker") {
+    return unique_ptr<MazeGenerator>(new BacktrackerGenerator());
+  } else if(name == "binary-tree") {
+    return unique_ptr<MazeGenerator>(new BinaryTreeGenerator());
+  } else if(name == "sidewinder") {
+    return unique_ptr<MazeGenerator>(new SidewinderGenerator());
+  }
+  return nullptr;
+}
+
+vector<string> GeneratorNames() {
+  return {"kruskal", "wilson", "prim", "backtracker", "binary-tree", "sidewinder"};
+}
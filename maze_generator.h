@@ -0,0 +1,87 @@
+// Created by Wei Shi
+// Interchangeable algorithms for generating perfect mazes.
+#ifndef MAZE_GENERATOR_H
+#define MAZE_GENERATOR_H
+
+#include <memory>
+#include <string>
+#include "maze.h"
+
+using namespace std;
+
+/**
+* Strategy interface for Maze::Generate(MazeGenerator*).
+* Generate receives a maze with every wall standing and opens walls until
+* the maze is a spanning tree of its cells. Each algorithm gives a different
+* texture (long corridors, many dead ends, diagonal bias, ...) at a different
+* cost in time and memory.
+*/
+class MazeGenerator {
+  public:
+    virtual ~MazeGenerator() {}
+    // @param seed determines the maze, see CounterRng.
+    virtual void Generate(Maze* maze, const uint64_t& seed) = 0;
+    virtual string name() const = 0;
+};
+
+// Randomized Kruskal, the Maze::Generate algorithm. Uses Maze::GenerateTiled
+// when tile_size is positive.
+class KruskalGenerator : public MazeGenerator {
+  public:
+    explicit KruskalGenerator(const size_t& num_threads = 1,
+                              const size_t& tile_size = 0)
+        : num_threads_(num_threads), tile_size_(tile_size) {}
+    void Generate(Maze* maze, const uint64_t& seed) override;
+    string name() const override { return "kruskal"; }
+
+  private:
+    size_t num_threads_;
+    size_t tile_size_;
+};
+
+// Loop-erased random walks, unbiased over all spanning trees.
+class WilsonGenerator : public MazeGenerator {
+  public:
+    void Generate(Maze* maze, const uint64_t& seed) override;
+    string name() const override { return "wilson"; }
+};
+
+// Randomized Prim, grows one tree from a random frontier cell.
+class PrimGenerator : public MazeGenerator {
+  public:
+    void Generate(Maze* maze, const uint64_t& seed) override;
+    string name() const override { return "prim"; }
+};
+
+// Randomized depth first search with an explicit stack, long corridors.
+class BacktrackerGenerator : public MazeGenerator {
+  public:
+    void Generate(Maze* maze, const uint64_t& seed) override;
+    string name() const override { return "backtracker"; }
+};
+
+// Every cell opens its right or its bottom wall, no extra memory at all.
+class BinaryTreeGenerator : public MazeGenerator {
+  public:
+    void Generate(Maze* maze, const uint64_t& seed) override;
+    string name() const override { return "binary-tree"; }
+};
+
+// Runs of cells along a row, each run opening one bottom wall.
+class SidewinderGenerator : public MazeGenerator {
+  public:
+    void Generate(Maze* maze, const uint64_t& seed) override;
+    string name() const override { return "sidewinder"; }
+};
+
+// @param name is one of kruskal, wilson, prim, backtracker, binary-tree or
+// sidewinder.
+// @param options supplies the threads and tile size used by kruskal.
+// @return the generator, or nullptr if name is unknown.
+unique_ptr<MazeGenerator> MakeGenerator(const string& name,
+                                        const MazeOptions& options);
+
+// @return names accepted by MakeGenerator.
+vector<string> GeneratorNames();
+
+#endif
@@ -0,0 +1,393 @@
+#include <atomic>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <thread>
+#include <unistd.h>
+
+#include "maze_render.h"
+using namespace std;
+
+namespace {
+
+// @return the 64 bits of plane starting at bit, which need not be aligned.
+uint64_t BitsAt(const vector<uint64_t>& plane, const size_t& bit) {
+  uint64_t bits = plane[bit >> 6] >> (bit & 63);
+  if((bit & 63) != 0 && (bit >> 6) + 1 < plane.size()) {
+    bits |= plane[(bit >> 6) + 1] << (64 - (bit & 63));
+  }
+  return bits;
+}
+
+// Writes all size bytes of data at offset of fd, pwrite may write less.
+// @return true if everything is OK, false otherwise.
+bool WriteAt(const int& fd, const unsigned char* data, size_t size,
+             off_t offset) {
+  ssize_t written;
+  while(size > 0) {
+    written = pwrite(fd, data, size, offset);
+    if(written <= 0) {
+      return false;
+    }
+    data += written;
+    size -= written;
+    offset += written;
+  }
+  return true;
+}
+
+// Sets bits [begin, end) of a pbm row, bit x in the 0x80 >> (x%8) bit of
+// byte x/8.
+void SetBits(const size_t& begin, const size_t& end, unsigned char* bits) {
+  if(begin >= end) {
+    return;
+  }
+  const size_t first = begin >> 3;
+  const size_t last = (end - 1) >> 3;
+  const unsigned char head = 0xff >> (begin & 7);
+  const unsigned char tail = 0xff << (7 - ((end - 1) & 7));
+  if(first == last) {
+    bits[first] |= head & tail;
+    return;
+  }
+  bits[first] |= head;
+  memset(bits + first + 1, 0xff, last - first - 1);
+  bits[last] |= tail;
+}
+
+// @return the kMazePalette index of shade, the closest one for shades not
+// in it.
+unsigned char PaletteIndex(const unsigned char& shade) {
+  unsigned char best = 0;
+  for(unsigned char i = 1; i < kMazePalette.size(); ++i) {
+    if(abs(kMazePalette[i] - shade) < abs(kMazePalette[best] - shade)) {
+      best = i;
+    }
+  }
+  return best;
+}
+
+}  // namespace
+
+void ScaleUnitLine(const unsigned char* unit_line, const size_t& unit_width,
+                   const size_t& scale, unsigned char* scanline) {
+  if(scale == 1) {
+    memcpy(scanline, unit_line, unit_width);
+    return;
+  }
+  size_t run_end;
+  for(size_t k = 0; k < unit_width; k = run_end) {
+    run_end = k + 1;
+    while(run_end < unit_width && unit_line[run_end] == unit_line[k]) {
+      ++run_end;
+    }
+    memset(scanline + k*scale, unit_line[k], (run_end - k)*scale);
+  }
+}
+
+ScanlineRenderer::ScanlineRenderer(const Maze& maze, const size_t& scale)
+    : maze_(maze), scale_(scale), unit_width_((2*maze.num_columns())+1),
+      unit_height_((2*maze.num_rows())+1), unit_line_(unit_width_, kWallShade),
+      solved_(false), start_(0), end_(0) {}
+
+void ScanlineRenderer::SetSolution(const PackedPath& path, const size_t& start,
+                                   const size_t& end) {
+  const size_t words = (maze_.size() + 63) / 64;
+  path_cells_.assign(words, 0);
+  path_right_.assign(words, 0);
+  path_down_.assign(words, 0);
+  auto mark = [](vector<uint64_t>* plane, const size_t& cell) {
+    (*plane)[cell >> 6] |= 1ULL << (cell & 63);
+  };
+  size_t previous = path.start();
+  for(const auto& cell: path) {
+    mark(&path_cells_, cell);
+    // an opening belongs to the cell left of or above it.
+    const size_t columns = path.columns();
+    if(cell == previous + columns) {
+      mark(&path_down_, previous);
+    } else if(cell + columns == previous) {
+      mark(&path_down_, cell);
+    } else if(cell == previous + 1) {
+      mark(&path_right_, previous);
+    } else if(cell + 1 == previous) {
+      mark(&path_right_, cell);
+    }
+    previous = cell;
+  }
+  start_ = start;
+  end_ = end;
+  solved_ = true;
+}
+
+void ScanlineRenderer::RenderUnitLine(const size_t& unit_row,
+                                      unsigned char* line) const {
+  const unsigned char shade[2] = {kOpenShade, kWallShade}; // by wall bit
+  const size_t columns = maze_.num_columns();
+  line[0] = kWallShade;
+  if(unit_row == 0) {
+    memset(line, kWallShade, unit_width_);
+    if(unit_width_ > 1) {
+      line[1] = kOpenShade; // create starting point
+    }
+    return;
+  }
+  const size_t row = (unit_row - 1) / 2;
+  const bool cell_line = unit_row % 2 == 1;
+  const vector<uint64_t>& plane = cell_line ? maze_.walls().right_walls()
+                                            : maze_.walls().bottom_walls();
+  uint64_t bits;
+  for(size_t j = 0; j < columns; j += 64) {
+    bits = BitsAt(plane, row*columns + j);
+    const size_t count = min((size_t)64, columns - j);
+    unsigned char* out = line + (2*j) + 1;
+    if(cell_line) {
+      // cell, then its right wall
+      for(size_t b = 0; b < count; ++b) {
+        out[2*b] = kOpenShade;
+        out[(2*b)+1] = shade[(bits >> b) & 1];
+      }
+    } else {
+      // bottom wall, then the corner after it
+      for(size_t b = 0; b < count; ++b) {
+        out[2*b] = shade[(bits >> b) & 1];
+        out[(2*b)+1] = kWallShade;
+      }
+    }
+  }
+  if(unit_row == unit_height_ - 1) {
+    line[unit_width_-2] = kOpenShade; // create ending point
+  }
+  if(solved_) {
+    DrawSolution(unit_row, line);
+  }
+}
+
+void ScanlineRenderer::RenderBits(const size_t& unit_row, unsigned char* bits) {
+  const unsigned char* line = RenderUnitLine(unit_row);
+  memset(bits, 0, (width() + 7) / 8);
+  size_t run_end;
+  for(size_t k = 0; k < unit_width_; k = run_end) {
+    run_end = k + 1;
+    while(run_end < unit_width_ && (line[run_end] == kOpenShade) == (line[k] == kOpenShade)) {
+      ++run_end;
+    }
+    if(line[k] != kOpenShade) {
+      SetBits(k*scale_, run_end*scale_, bits);
+    }
+  }
+}
+
+void ScanlineRenderer::RenderIndexed(const size_t& unit_row,
+                                     unsigned char* nibbles) {
+  const unsigned char* line = RenderUnitLine(unit_row);
+  memset(nibbles, 0, BmpRowBytes(width()));
+  size_t x = 0; // next pixel
+  size_t run_end;
+  for(size_t k = 0; k < unit_width_; k = run_end) {
+    run_end = k + 1;
+    while(run_end < unit_width_ && line[run_end] == line[k]) {
+      ++run_end;
+    }
+    const unsigned char index = PaletteIndex(line[k]);
+    const size_t end = run_end*scale_;
+    // a pixel to the low nibble, whole bytes, then a pixel to the high one.
+    if(x < end && (x & 1) == 1) {
+      nibbles[x >> 1] |= index;
+      ++x;
+    }
+    const size_t pairs = (end - x) >> 1;
+    memset(nibbles + (x >> 1), index * 0x11, pairs);
+    x += 2*pairs;
+    if(x < end) {
+      nibbles[x >> 1] |= index << 4;
+      ++x;
+    }
+  }
+}
+
+void ScanlineRenderer::DrawSolution(const size_t& unit_row,
+                                    unsigned char* line) const {
+  const size_t columns = maze_.num_columns();
+  const size_t row = (unit_row - 1) / 2;
+  // every set bit of plane in the row paints the unit pixel at offset
+  // after its cell's.
+  auto paint = [&](const vector<uint64_t>& plane, const size_t& offset) {
+    uint64_t bits;
+    for(size_t j = 0; j < columns; j += 64) {
+      bits = BitsAt(plane, row*columns + j);
+      if(columns - j < 64) {
+        bits &= (1ULL << (columns - j)) - 1;
+      }
+      for(; bits != 0; bits &= bits - 1) {
+        line[(2*(j + __builtin_ctzll(bits))) + 1 + offset] = kPathShade;
+      }
+    }
+  };
+  if(unit_row % 2 == 1) {
+    paint(path_cells_, 0);
+    paint(path_right_, 1);
+    if(start_ / columns == row) {
+      line[(2*(start_ % columns)) + 1] = kStartShade;
+    }
+    if(end_ / columns == row) {
+      line[(2*(end_ % columns)) + 1] = kEndShade;
+    }
+  } else if(unit_row != 0) {
+    paint(path_down_, 0);
+  }
+}
+
+PathOverlay::PathOverlay(const Maze& maze, const size_t& scale, Image* image)
+    : columns_(maze.num_columns()), scale_(scale), image_(image) {}
+
+void PathOverlay::DrawPath(const PackedPath& path, const unsigned char& shade) {
+  size_t previous = path.start();
+  for(const auto& cell: path) {
+    // the opening between two cells sits between their unit pixels, at the
+    // sum of their rows and columns plus the border.
+    PaintUnit((cell/columns_) + (previous/columns_) + 1,
+              (cell%columns_) + (previous%columns_) + 1, shade);
+    if(cell != previous) {
+      PaintUnit((2*(cell/columns_)) + 1, (2*(cell%columns_)) + 1, shade);
+    }
+    previous = cell;
+  }
+}
+
+void PathOverlay::DrawCell(const size_t& cell, const unsigned char& shade) {
+  PaintUnit((2*(cell/columns_)) + 1, (2*(cell%columns_)) + 1, shade);
+}
+
+void PathOverlay::Clear() {
+  const size_t unit_width = (2*columns_) + 1;
+  // newest first, so a pixel painted twice gets its first shade back.
+  for(auto it = saved_.rbegin(); it != saved_.rend(); ++it) {
+    const size_t unit_row = it->first / unit_width;
+    const size_t unit_col = it->first % unit_width;
+    for(size_t i = unit_row*scale_; i < (unit_row+1)*scale_; ++i) {
+      memset(image_->span(i, unit_col*scale_, scale_), it->second, scale_);
+    }
+  }
+  saved_.clear();
+}
+
+void PathOverlay::PaintUnit(const size_t& unit_row, const size_t& unit_col,
+                            const unsigned char& shade) {
+  saved_.emplace_back(unit_row*((2*columns_) + 1) + unit_col,
+                      image_->GetPixel(unit_row*scale_, unit_col*scale_));
+  for(size_t i = unit_row*scale_; i < (unit_row+1)*scale_; ++i) {
+    memset(image_->span(i, unit_col*scale_, scale_), shade, scale_);
+  }
+}
+
+bool WriteMazeImage(const string& filename, ScanlineRenderer* renderer,
+                    const MazeImageFormat& format, const size_t& num_threads) {
+  PgmWriter pgm;
+  PbmWriter pbm;
+  BmpWriter bmp;
+  PngWriter png(num_threads);
+  RasterWriter* writer;
+  bool opened;
+  switch(format) {
+    case MazeImageFormat::kPng:
+      opened = png.Open(filename, renderer->height(), renderer->width());
+      writer = &png;
+      break;
+    case MazeImageFormat::kPbm:
+      opened = pbm.Open(filename, renderer->height(), renderer->width());
+      writer = &pbm;
+      break;
+    case MazeImageFormat::kBmp:
+      opened = bmp.Open(filename, renderer->height(), renderer->width(),
+                        kMazePalette);
+      writer = &bmp;
+      break;
+    default:
+      opened = pgm.Open(filename, renderer->height(), renderer->width(), 255);
+      writer = &pgm;
+  }
+  if(!opened) {
+    return false;
+  }
+  vector<unsigned char> scanline(writer->row_bytes());
+  for(size_t unit_row = 0; unit_row < renderer->unit_height(); ++unit_row) {
+    switch(format) {
+      case MazeImageFormat::kPbm:
+        renderer->RenderBits(unit_row, scanline.data());
+        break;
+      case MazeImageFormat::kBmp:
+        renderer->RenderIndexed(unit_row, scanline.data());
+        break;
+      default:
+        renderer->Render(unit_row, scanline.data());
+    }
+    for(size_t i = 0; i < renderer->scale(); ++i) {
+      if(!writer->WriteRow(scanline.data())) {
+        return false;
+      }
+    }
+  }
+  return writer->Close();
+}
+
+bool WriteMazeImage(const string& filename, const ScanlineRenderer& renderer,
+                    const size_t& num_threads) {
+  int fd = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if(fd < 0) {
+    cout << "WriteMazeImage: cannot open file" << endl;
+    return false;
+  }
+  // Same header as WriteImage.
+  char header[96];
+  const int header_size = snprintf(header, sizeof(header), "P5\n#\n%zu %zu\n%03d\n",
+                                   renderer.width(), renderer.height(), 255);
+  const size_t width = renderer.width();
+  const size_t unit_bytes = width*renderer.scale(); // bytes of one unit row
+  if(!WriteAt(fd, (const unsigned char*)header, header_size, 0)
+     || ftruncate(fd, header_size + (off_t)(unit_bytes*renderer.unit_height())) != 0) {
+    cout << "WriteMazeImage: could not write" << endl;
+    close(fd);
+    return false;
+  }
+
+  const size_t band_rows = max((size_t)1, ((size_t)1 << 20) / max((size_t)1, unit_bytes));
+  const size_t num_bands = (renderer.unit_height() + band_rows - 1) / band_rows;
+  atomic<size_t> next_band(0);
+  atomic<bool> failed(false);
+  auto worker = [&]() {
+    vector<unsigned char> unit_line(renderer.unit_width());
+    vector<unsigned char> band(min(band_rows, renderer.unit_height())*unit_bytes);
+    size_t b;
+    while(!failed && (b = next_band.fetch_add(1)) < num_bands) {
+      const size_t first = b*band_rows;
+      const size_t last = min(first + band_rows, renderer.unit_height());
+      unsigned char* out = band.data();
+      for(size_t unit_row = first; unit_row < last; ++unit_row) {
+        renderer.RenderUnitLine(unit_row, unit_line.data());
+        ScaleUnitLine(unit_line.data(), unit_line.size(), renderer.scale(), out);
+        for(size_t i = 1; i < renderer.scale(); ++i) {
+          memcpy(out + i*width, out, width);
+        }
+        out += unit_bytes;
+      }
+      if(!WriteAt(fd, band.data(), out - band.data(),
+                  header_size + (off_t)(first*unit_bytes))) {
+        failed = true;
+      }
+    }
+  };
+  vector<thread> threads;
+  for(size_t i = 1; i < num_threads && i < num_bands; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for(auto& t: threads) {
+    t.join();
+  }
+  const bool ok = close(fd) == 0 && !failed;
+  if(!ok) {
+    cout << "WriteMazeImage: could not write" << endl;
+  }
+  return ok;
+}
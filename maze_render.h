@@ -0,0 +1,168 @@
+// Created by Wei Shi
+// Scanline rendering of maze images straight from the wall bitplanes.
+#ifndef MAZE_RENDER_H
+#define MAZE_RENDER_H
+
+#include <string>
+#include <vector>
+#include "maze.h"
+#include "packed_path.h"
+
+using namespace std;
+
+// Gray levels of a rendered maze.
+const unsigned char kWallShade = 130;
+const unsigned char kOpenShade = 255;
+const unsigned char kPathShade = 200; // cells and openings of a solution
+const unsigned char kStartShade = 90; // first cell of a solution
+const unsigned char kEndShade = 0; // last cell of a solution
+
+// Gray levels of the 4 bit images of WriteMazeImage, indexed by palette
+// entry: end, start, wall, path and open.
+const vector<unsigned char> kMazePalette = {kEndShade, kStartShade, kWallShade,
+                                            kPathShade, kOpenShade};
+
+// File formats WriteMazeImage can write.
+enum class MazeImageFormat {
+  kPgm, // 8 bit gray levels, the same file as WriteImage
+  kPbm, // 1 bit, black for every pixel that is not kOpenShade, see PbmWriter
+  kBmp, // 4 bit indices into kMazePalette, see BmpWriter
+  kPng // 8 bit gray levels deflated, see PngWriter
+};
+
+// Expands a line of unit pixels, one per cell, wall or corner, by scale.
+// Runs of equal unit pixels become a single memset, and scale 1 a memcpy.
+// @param unit_width is the number of unit pixels.
+// @param scanline gets unit_width*scale pixels.
+void ScaleUnitLine(const unsigned char* unit_line, const size_t& unit_width,
+                   const size_t& scale, unsigned char* scanline);
+
+/**
+* Renders the image of Maze::get_image one unit row at a time. Unit row
+* 2r+1 crosses the cells of row r and their right walls, unit row 2r+2
+* their bottom walls and the corners between them, and unit row 0 is the
+* top border. A line is built from 64 cells of a wall bitplane at a time,
+* then scaled by ScaleUnitLine, so every pixel is written once and no
+* pixel is bounds checked. With a solution set, lines are drawn like
+* get_solved_image's instead.
+*/
+class ScanlineRenderer {
+  public:
+    // @param scale in pixels of size of each cell.
+    ScanlineRenderer(const Maze& maze, const size_t& scale);
+
+    // Draws path over the maze in kPathShade, then start in kStartShade and
+    // end in kEndShade, like the row and column get_solved_image. The path
+    // is kept as three bits per cell, its cells and its openings to the
+    // right and down, so rows can be drawn in any order.
+    // @param path may be empty, only start and end are drawn then.
+    void SetSolution(const PackedPath& path, const size_t& start,
+                     const size_t& end);
+
+    // Renders the unit line of unit_row, 2*num_rows()+1 of them.
+    // @return the unit_width() unit pixels, valid until the next call.
+    const unsigned char* RenderUnitLine(const size_t& unit_row) {
+      RenderUnitLine(unit_row, unit_line_.data());
+      return unit_line_.data();
+    }
+    // Same, into line, so threads can share one renderer.
+    // @param line gets unit_width() unit pixels.
+    void RenderUnitLine(const size_t& unit_row, unsigned char* line) const;
+    // Renders the scanline of every image row of unit_row.
+    // @param scanline gets width() pixels.
+    void Render(const size_t& unit_row, unsigned char* scanline) {
+      ScaleUnitLine(RenderUnitLine(unit_row), unit_width_, scale_, scanline);
+    }
+    // Same, packed as a PbmWriter row, 1 for every pixel not kOpenShade.
+    // @param bits gets (width()+7)/8 bytes.
+    void RenderBits(const size_t& unit_row, unsigned char* bits);
+    // Same, packed as a BmpWriter row of kMazePalette indices.
+    // @param nibbles gets BmpRowBytes(width()) bytes.
+    void RenderIndexed(const size_t& unit_row, unsigned char* nibbles);
+
+    size_t unit_width() const { return unit_width_; }
+    size_t unit_height() const { return unit_height_; }
+    // @return image width in pixels.
+    size_t width() const { return unit_width_*scale_; }
+    // @return image height in pixels.
+    size_t height() const { return unit_height_*scale_; }
+    size_t scale() const { return scale_; }
+    // @return true once SetSolution was called.
+    bool solved() const { return solved_; }
+
+  private:
+    // Draws the solution over line, the unit line of unit_row.
+    void DrawSolution(const size_t& unit_row, unsigned char* line) const;
+
+    const Maze& maze_;
+    size_t scale_;
+    size_t unit_width_;
+    size_t unit_height_;
+    vector<unsigned char> unit_line_;
+    bool solved_;
+    vector<uint64_t> path_cells_; // bit set if the cell is on the path
+    vector<uint64_t> path_right_; // bit set if the path crosses the right wall
+    vector<uint64_t> path_down_; // bit set if the path crosses the bottom wall
+    size_t start_;
+    size_t end_;
+};
+
+/**
+* Paints paths over an image rendered by Maze::get_image and takes them off
+* again, so one render serves any number of solved images: each costs the
+* length of its path instead of another render of the maze. Only the unit
+* pixels of path cells and the openings between them are painted, scale
+* by scale pixels each, and the shade under each one is saved first so
+* Clear can put it back. Paths drawn without a Clear between them stack, the
+* last one on top, so many paths can share one image in different shades.
+*/
+class PathOverlay {
+  public:
+    // @param image is maze.get_image(scale), painted in place. It must
+    // outlive the overlay.
+    PathOverlay(const Maze& maze, const size_t& scale, Image* image);
+
+    // Paints the cells of path and the openings between them in shade.
+    void DrawPath(const PackedPath& path, const unsigned char& shade = kPathShade);
+    // Paints the single cell in shade, as for the start and end markers.
+    void DrawCell(const size_t& cell, const unsigned char& shade);
+    // Restores every pixel painted since construction or the last Clear.
+    void Clear();
+
+    // @return number of unit pixels Clear would restore.
+    size_t painted() const { return saved_.size(); }
+
+  private:
+    // Paints the scale by scale block of unit pixel (unit_row, unit_col).
+    void PaintUnit(const size_t& unit_row, const size_t& unit_col,
+                   const unsigned char& shade);
+
+    size_t columns_; // of cells
+    size_t scale_;
+    Image* image_;
+    // unit pixels painted, unit_row*unit width + unit_col, and the shade they
+    // had before, oldest first.
+    vector<pair<size_t, unsigned char>> saved_;
+};
+
+// Writes the image renderer draws to filename one scanline at a time, so
+// memory is a few scanlines whatever the height. As kPgm the file is the
+// one WriteImage writes for the same image. kPbm only tells walls from open
+// pixels, so it suits unsolved mazes, and kBmp keeps every shade at half
+// the size of kPgm. kPng keeps every shade too and is usually the smallest.
+// @param num_threads deflate kPng, the other formats use one thread.
+// @return true if everything is OK, false otherwise.
+bool WriteMazeImage(const string& filename, ScanlineRenderer* renderer,
+                    const MazeImageFormat& format = MazeImageFormat::kPgm,
+                    const size_t& num_threads = 1);
+
+// Writes the same file as WriteMazeImage with num_threads threads. The file
+// is sized up front, then threads take bands of unit rows of about 1MB of
+// pixels, render each into their own buffer and pwrite it at its offset,
+// so rendering and writing both run on every thread. filename must be a
+// regular file.
+// @return true if everything is OK, false otherwise.
+bool WriteMazeImage(const string& filename, const ScanlineRenderer& renderer,
+                    const size_t& num_threads);
+
+#endif
@@ -0,0 +1,668 @@
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "maze_solver.h"
+using namespace std;
+
+namespace {
+
+// Collects the cells one move away from cell through an open wall.
+// @return number of neighbors written to neighbors.
+unsigned int OpenNeighbors(const Maze& maze, const size_t& cell,
+                           size_t neighbors[4]) {
+  const size_t columns = maze.num_columns();
+  unsigned int count = 0;
+  // boundary walls always stand, so only left and up need a bounds check.
+  if(cell % columns != 0 && !maze.HasRightWall(cell-1)) {
+    neighbors[count++] = cell-1;
+  }
+  if(cell >= columns && !maze.HasBottomWall(cell-columns)) {
+    neighbors[count++] = cell-columns;
+  }
+  if(!maze.HasRightWall(cell)) {
+    neighbors[count++] = cell+1;
+  }
+  if(!maze.HasBottomWall(cell)) {
+    neighbors[count++] = cell+columns;
+  }
+  return count;
+}
+
+size_t Difference(const size_t& a, const size_t& b) {
+  return a > b ? a - b : b - a;
+}
+
+}  // namespace
+
+bool MazeSolver::SolvePacked(const Maze& maze, const size_t& start,
+                             const size_t& end, PackedPath* path) {
+  path->Clear();
+  vector<size_t> cells;
+  if(!Solve(maze, start, end, &cells)) {
+    return false;
+  }
+  *path = PackedPath(start, maze.num_columns());
+  for(size_t i = 1; i < cells.size(); ++i) {
+    path->PushCell(cells[i]);
+  }
+  return true;
+}
+
+bool BfsSolver::Solve(const Maze& maze, const size_t& start, const size_t& end,
+                      vector<size_t>* path) {
+  path->clear();
+  if(!Search(maze, start, end)) {
+    return false;
+  }
+  for(size_t cell = end; cell != start; cell = parent_[cell]) {
+    path->push_back(cell);
+  }
+  path->push_back(start);
+  reverse(path->begin(), path->end());
+  return true;
+}
+
+bool BfsSolver::SolvePacked(const Maze& maze, const size_t& start,
+                            const size_t& end, PackedPath* path) {
+  path->Clear();
+  if(!Search(maze, start, end)) {
+    return false;
+  }
+  *path = PackedPath(end, maze.num_columns());
+  for(size_t cell = end; cell != start; cell = parent_[cell]) {
+    path->PushCell(parent_[cell]);
+  }
+  path->Reverse();
+  return true;
+}
+
+bool BfsSolver::Search(const Maze& maze, const size_t& start, const size_t& end) {
+  expanded_ = 0;
+  if(start >= maze.size() || end >= maze.size()) {
+    return false;
+  }
+  Prepare(maze);
+  const size_t columns = maze.num_columns();
+  size_t cell;
+  Visit(start, start);
+  for(size_t head = 0; head < tail_; ++head) {
+    cell = queue_[head];
+    expanded_ = head + 1;
+    if(cell == end) {
+      return true;
+    }
+    // boundary walls always stand, so only left and up need a bounds check.
+    if(cell % columns != 0 && !maze.HasRightWall(cell-1) && !IsVisited(cell-1)) {
+      Visit(cell-1, cell);
+    }
+    if(cell >= columns && !maze.HasBottomWall(cell-columns)
+       && !IsVisited(cell-columns)) {
+      Visit(cell-columns, cell);
+    }
+    if(!maze.HasRightWall(cell) && !IsVisited(cell+1)) {
+      Visit(cell+1, cell);
+    }
+    if(!maze.HasBottomWall(cell) && !IsVisited(cell+columns)) {
+      Visit(cell+columns, cell);
+    }
+  }
+  return false;
+}
+
+void BfsSolver::Prepare(const Maze& maze) {
+  if(parent_.size() != maze.size()) {
+    parent_.assign(maze.size(), 0);
+    queue_.assign(maze.size(), 0);
+    visited_.assign((maze.size() + 63) / 64, 0);
+  } else {
+    fill(visited_.begin(), visited_.end(), 0);
+  }
+  tail_ = 0;
+}
+
+bool AStarSolver::Solve(const Maze& maze, const size_t& start, const size_t& end,
+                        vector<size_t>* path) {
+  path->clear();
+  expanded_ = 0;
+  if(start >= maze.size() || end >= maze.size()) {
+    return false;
+  }
+  if(nodes_.size() != maze.size()) {
+    nodes_.assign(maze.size(), Node{0, 0, 0, 0});
+    search_ = 0;
+  }
+  if(++search_ == 0) {
+    // the tags wrapped around, forget every earlier search.
+    for(auto& node: nodes_) {
+      node.seen = node.closed = 0;
+    }
+    search_ = 1;
+  }
+  const size_t columns = maze.num_columns();
+  auto heuristic = [&](const size_t& cell) {
+    return Difference(cell / columns, end / columns)
+           + Difference(cell % columns, end % columns);
+  };
+  size_t neighbors[4];
+  size_t estimate = heuristic(start); // F, the lowest estimate still open
+  open_.assign(1, start);
+  later_.clear();
+  nodes_[start] = Node{start, 0, search_, 0};
+  while(!open_.empty() || !later_.empty()) {
+    if(open_.empty()) {
+      swap(open_, later_);
+      estimate += 2;
+    }
+    const size_t cell = open_.back();
+    open_.pop_back();
+    Node& node = nodes_[cell];
+    if(node.closed == search_) {
+      continue; // a stale entry, the cell was expanded at a lower cost.
+    }
+    node.closed = search_;
+    ++expanded_;
+    if(cell == end) {
+      for(size_t c = end; c != start; c = nodes_[c].parent) {
+        path->push_back(c);
+      }
+      path->push_back(start);
+      reverse(path->begin(), path->end());
+      return true;
+    }
+    const unsigned int count = OpenNeighbors(maze, cell, neighbors);
+    for(unsigned int k = 0; k < count; ++k) {
+      Node& next = nodes_[neighbors[k]];
+      if(next.seen != search_ || node.cost + 1 < next.cost) {
+        next.parent = cell;
+        next.cost = node.cost + 1;
+        next.seen = search_;
+        if(next.cost + heuristic(neighbors[k]) == estimate) {
+          open_.push_back(neighbors[k]);
+        } else {
+          later_.push_back(neighbors[k]);
+        }
+      }
+    }
+  }
+  return false;
+}
+
+bool BidirectionalSolver::Solve(const Maze& maze, const size_t& start,
+                                const size_t& end, vector<size_t>* path) {
+  path->clear();
+  expanded_ = 0;
+  if(start >= maze.size() || end >= maze.size()) {
+    return false;
+  }
+  if(start == end) {
+    path->push_back(start);
+    return true;
+  }
+  if(nodes_.size() != maze.size()) {
+    nodes_.assign(maze.size(), Node{0, 0, 0, 0});
+    search_ = 0;
+  }
+  if(++search_ == 0) {
+    for(auto& node: nodes_) {
+      node.seen = 0;
+    }
+    search_ = 1;
+  }
+  nodes_[start] = Node{start, 0, search_, 0};
+  nodes_[end] = Node{end, 0, search_, 1};
+  frontiers_[0].assign(1, start);
+  frontiers_[1].assign(1, end);
+  while(!frontiers_[0].empty() && !frontiers_[1].empty()) {
+    const unsigned char side = frontiers_[0].size() <= frontiers_[1].size() ? 0 : 1;
+    pair<size_t, size_t> meeting = ExpandLevel(maze, side, &frontiers_[side], &next_);
+    swap(frontiers_[side], next_);
+    if(meeting.first == SIZE_MAX) {
+      continue;
+    }
+    if(side == 1) {
+      swap(meeting.first, meeting.second);
+    }
+    for(size_t cell = meeting.first; cell != start; cell = nodes_[cell].parent) {
+      path->push_back(cell);
+    }
+    path->push_back(start);
+    reverse(path->begin(), path->end());
+    for(size_t cell = meeting.second; cell != end; cell = nodes_[cell].parent) {
+      path->push_back(cell);
+    }
+    path->push_back(end);
+    return true;
+  }
+  return false;
+}
+
+pair<size_t, size_t> BidirectionalSolver::ExpandLevel(const Maze& maze,
+                                                      const unsigned char& side,
+                                                      vector<size_t>* frontier,
+                                                      vector<size_t>* next) {
+  pair<size_t, size_t> meeting(SIZE_MAX, SIZE_MAX);
+  size_t meeting_length = SIZE_MAX;
+  size_t neighbors[4];
+  next->clear();
+  // The whole level is expanded even after a meeting, since a later cell of
+  // the level can meet the other side closer to its end.
+  for(const auto& cell: *frontier) {
+    ++expanded_;
+    const Node& node = nodes_[cell];
+    const unsigned int count = OpenNeighbors(maze, cell, neighbors);
+    for(unsigned int k = 0; k < count; ++k) {
+      Node& neighbor = nodes_[neighbors[k]];
+      if(neighbor.seen != search_) {
+        neighbor = Node{cell, node.distance + 1, search_, side};
+        next->push_back(neighbors[k]);
+      } else if(neighbor.side != side
+                && node.distance + 1 + neighbor.distance < meeting_length) {
+        meeting_length = node.distance + 1 + neighbor.distance;
+        meeting = pair<size_t, size_t>(cell, neighbors[k]);
+      }
+    }
+  }
+  return meeting;
+}
+
+bool BitParallelSolver::Solve(const Maze& maze, const size_t& start,
+                              const size_t& end, vector<size_t>* path) {
+  path->clear();
+  expanded_ = 0;
+  if(start >= maze.size() || end >= maze.size()) {
+    return false;
+  }
+  Prepare(maze);
+  const size_t rows = maze.num_rows();
+  const size_t columns = maze.num_columns();
+  const size_t words = words_per_row_;
+  const size_t end_word = (end / columns)*words + ((end % columns) >> 6);
+  const uint64_t end_bit = 1ULL << ((end % columns) & 63);
+  const size_t start_word = (start / columns)*words + ((start % columns) >> 6);
+  frontier_[start_word] = visited_[start_word] = 1ULL << ((start % columns) & 63);
+  active_.assign(1, start_word);
+  uint32_t level = 0;
+  // A word enters next_active_ the first time it gets a cell this level.
+  auto add = [&](const size_t& word, uint64_t bits) {
+    bits &= ~visited_[word];
+    if(bits == 0) {
+      return;
+    }
+    if(next_[word] == 0) {
+      next_active_.push_back(word);
+    }
+    next_[word] |= bits;
+  };
+  while(!(visited_[end_word] & end_bit)) {
+    if(active_.empty()) {
+      return false;
+    }
+    ++level;
+    next_active_.clear();
+    for(const auto& word: active_) {
+      const uint64_t cells = frontier_[word];
+      const uint64_t right = cells & open_right_[word];
+      expanded_ += __builtin_popcountll(cells);
+      add(word, (right << 1) | ((cells >> 1) & open_right_[word]));
+      if(word % words != words - 1) {
+        add(word + 1, right >> 63);
+      }
+      if(word % words != 0) {
+        add(word - 1, (cells << 63) & open_right_[word - 1]);
+      }
+      if(word / words != rows - 1) {
+        add(word + words, cells & open_down_[word]);
+      }
+      if(word >= words) {
+        add(word - words, cells & open_down_[word - words]);
+      }
+      frontier_[word] = 0;
+    }
+    // next_ becomes the frontier, the old frontier is all zero again.
+    swap(frontier_, next_);
+    swap(active_, next_active_);
+    for(const auto& word: active_) {
+      visited_[word] |= frontier_[word];
+      if(level % 3 == 1) {
+        level_low_[word] |= frontier_[word];
+      } else if(level % 3 == 2) {
+        level_high_[word] |= frontier_[word];
+      }
+    }
+  }
+
+  // Walk back from end, one level down at a time. Neighbors are tried in
+  // BfsSolver's order.
+  size_t row = end / columns;
+  size_t col = end % columns;
+  unsigned int previous;
+  path->push_back(end);
+  for(uint32_t l = level; l > 0; --l) {
+    previous = (l - 1) % 3;
+    if(col > 0 && Test(open_right_, row, col-1) && Test(visited_, row, col-1)
+       && Level(row, col-1) == previous) {
+      --col;
+    } else if(row > 0 && Test(open_down_, row-1, col) && Test(visited_, row-1, col)
+              && Level(row-1, col) == previous) {
+      --row;
+    } else if(Test(open_right_, row, col) && Test(visited_, row, col+1)
+              && Level(row, col+1) == previous) {
+      ++col;
+    } else {
+      ++row;
+    }
+    path->push_back(row*columns + col);
+  }
+  reverse(path->begin(), path->end());
+  return true;
+}
+
+void BitParallelSolver::Prepare(const Maze& maze) {
+  const size_t rows = maze.num_rows();
+  const size_t columns = maze.num_columns();
+  words_per_row_ = (columns + 63) / 64;
+  const size_t size = rows*words_per_row_;
+  for(auto plane: {&open_right_, &open_down_, &visited_, &frontier_, &next_,
+                   &level_low_, &level_high_}) {
+    plane->assign(size, 0);
+  }
+  // WallStore packs cells back to back, a row starts at any bit.
+  auto extract = [&](const vector<uint64_t>& plane, const size_t& bit) {
+    uint64_t bits = plane[bit >> 6] >> (bit & 63);
+    if((bit & 63) != 0 && (bit >> 6) + 1 < plane.size()) {
+      bits |= plane[(bit >> 6) + 1] << (64 - (bit & 63));
+    }
+    return bits;
+  };
+  const vector<uint64_t>& right_walls = maze.walls().right_walls();
+  const vector<uint64_t>& bottom_walls = maze.walls().bottom_walls();
+  uint64_t mask;
+  for(size_t row = 0; row < rows; ++row) {
+    for(size_t w = 0; w < words_per_row_; ++w) {
+      const size_t first = row*columns + 64*w;
+      mask = columns - 64*w >= 64 ? ~0ULL : (1ULL << (columns - 64*w)) - 1;
+      open_right_[row*words_per_row_ + w] = ~extract(right_walls, first) & mask;
+      open_down_[row*words_per_row_ + w] = ~extract(bottom_walls, first) & mask;
+    }
+  }
+}
+
+void ComputeDistanceField(const Maze& maze, const size_t& source,
+                          const size_t& num_threads, vector<uint32_t>* distance) {
+  const size_t n = maze.size();
+  distance->assign(n, kUnreachable);
+  if(source >= n) {
+    return;
+  }
+  const size_t threads = max((size_t)1, num_threads);
+  const size_t chunk_size = 1024;
+  uint32_t* field = distance->data();
+  // One bit per cell that has a distance. Searches test the bits instead of
+  // the field, which is 32 times larger and mostly out of cache, and
+  // threads claim a cell with a fetch_or on its bit.
+  vector<uint64_t> claimed((n + 63) / 64, 0);
+  uint64_t* bits = claimed.data();
+  auto is_claimed = [&](const size_t& cell) {
+    return (__atomic_load_n(&bits[cell >> 6], __ATOMIC_RELAXED) >> (cell & 63)) & 1;
+  };
+  auto claim = [&](const size_t& cell) {
+    const uint64_t bit = 1ULL << (cell & 63);
+    return !(__atomic_fetch_or(&bits[cell >> 6], bit, __ATOMIC_RELAXED) & bit);
+  };
+
+  // Written only by the barrier's completion, read by every thread after it.
+  vector<size_t> frontier(1, source);
+  vector<size_t> next;
+  size_t frontier_size = 1;
+  size_t visited = 1;
+  uint32_t level = 0;
+  bool bottom_up = false;
+  atomic<size_t> next_size(0);
+  atomic<size_t> next_chunk(0);
+  SpinBarrier barrier(threads);
+  field[source] = 0;
+  bits[source >> 6] |= 1ULL << (source & 63);
+
+  // Makes next the frontier and picks the direction of the level after it.
+  auto advance = [&]() {
+    swap(frontier, next);
+    frontier_size = next_size.load(memory_order_relaxed);
+    visited += frontier_size;
+    ++level;
+    // A bottom up level costs a pass over every cell, so it needs a frontier
+    // that is a fair share of the whole maze too, not only of the cells
+    // left near the end of the search.
+    if(!bottom_up && frontier_size > (n - visited) / 14 && frontier_size >= n / 24) {
+      bottom_up = true;
+    } else if(bottom_up && frontier_size < n / 24) {
+      bottom_up = false;
+    }
+    // every frontier cell reaches at most four new cells.
+    const size_t capacity = bottom_up ? n - visited : min(n - visited, 4*frontier_size);
+    if(next.size() < capacity) {
+      next.resize(capacity);
+    }
+    next_size.store(0, memory_order_relaxed);
+    next_chunk.store(0, memory_order_relaxed);
+  };
+  // Levels too small to split are expanded top down on one thread, with
+  // plain stores, until the frontier grows. Maze frontiers are often a few
+  // cells wide for thousands of levels, and a barrier per level would cost
+  // more than the level itself.
+  const size_t serial_frontier = threads == 1 ? SIZE_MAX : 4*chunk_size;
+  auto expand_small_levels = [&]() {
+    size_t neighbors[4];
+    while(frontier_size > 0 && frontier_size < serial_frontier && !bottom_up) {
+      // locals, so the stores below can't alias the captured state.
+      const size_t* from = frontier.data();
+      size_t* to = next.data();
+      const size_t count = frontier_size;
+      const uint32_t next_level = level + 1;
+      size_t found = 0;
+      for(size_t i = 0; i < count; ++i) {
+        const unsigned int open = OpenNeighbors(maze, from[i], neighbors);
+        for(unsigned int k = 0; k < open; ++k) {
+          const size_t cell = neighbors[k];
+          if(!((bits[cell >> 6] >> (cell & 63)) & 1)) {
+            bits[cell >> 6] |= 1ULL << (cell & 63);
+            field[cell] = next_level;
+            to[found++] = cell;
+          }
+        }
+      }
+      next_size.store(found, memory_order_relaxed);
+      advance();
+    }
+  };
+  auto end_level = [&]() {
+    advance();
+    expand_small_levels();
+  };
+  next.resize(min(n - 1, (size_t)4));
+  expand_small_levels();
+
+  auto worker = [&]() {
+    vector<size_t> found;
+    size_t neighbors[4];
+    auto flush = [&]() {
+      const size_t at = next_size.fetch_add(found.size(), memory_order_relaxed);
+      copy(found.begin(), found.end(), next.begin() + at);
+      found.clear();
+    };
+    while(frontier_size > 0) {
+      const size_t total = bottom_up ? n : frontier_size;
+      size_t begin;
+      while((begin = next_chunk.fetch_add(chunk_size, memory_order_relaxed)) < total) {
+        const size_t end = min(begin + chunk_size, total);
+        for(size_t i = begin; i < end; ++i) {
+          if(bottom_up) {
+            if(is_claimed(i)) {
+              continue;
+            }
+            const unsigned int count = OpenNeighbors(maze, i, neighbors);
+            for(unsigned int k = 0; k < count; ++k) {
+              if(__atomic_load_n(&field[neighbors[k]], __ATOMIC_RELAXED) == level) {
+                // only this thread looks at cell i during the level.
+                claim(i);
+                __atomic_store_n(&field[i], level + 1, __ATOMIC_RELAXED);
+                found.push_back(i);
+                break;
+              }
+            }
+          } else {
+            const unsigned int count = OpenNeighbors(maze, frontier[i], neighbors);
+            for(unsigned int k = 0; k < count; ++k) {
+              if(!is_claimed(neighbors[k]) && claim(neighbors[k])) {
+                __atomic_store_n(&field[neighbors[k]], level + 1, __ATOMIC_RELAXED);
+                found.push_back(neighbors[k]);
+              }
+            }
+          }
+        }
+        if(found.size() >= chunk_size) {
+          flush();
+        }
+      }
+      flush();
+      barrier.Wait(end_level);
+    }
+  };
+  vector<thread> pool;
+  for(size_t t = 1; t < threads; ++t) {
+    pool.emplace_back(worker);
+  }
+  worker();
+  for(auto& t: pool) {
+    t.join();
+  }
+}
+
+unique_ptr<MazeSolver> MakeSolver(const string& name) {
+  if(name == "bfs") {
+    return unique_ptr<MazeSolver>(new BfsSolver());
+  } else if(name == "astar") {
+    return unique_ptr<MazeSolver>(new AStarSolver());
+  } else if(name == "bidirectional") {
+    return unique_ptr<MazeSolver>(new BidirectionalSolver());
+  } else if(name == "bitparallel") {
+    return unique_ptr<MazeSolver>(new BitParallelSolver());
+  }
+  return nullptr;
+}
+
+vector<string> SolverNames() {
+  return {"bfs", "astar", "bidirectional", "bitparallel"};
+}
+
+const size_t MazeTree::kNoPath;
+
+MazeTree::MazeTree(const Maze& maze, const size_t& root) {
+  const size_t n = maze.size();
+  const size_t columns = maze.num_columns();
+  nodes_.assign(n, Node{0, kNoPath, 0});
+  if(root >= n) {
+    return;
+  }
+  // cells in the order they were reached, parents always before children.
+  vector<size_t> order(n);
+  size_t tail = 0;
+  // Skew binary jump pointers: if the parent's jump spans as many levels as
+  // the jump after it, the child jumps over both, otherwise to its parent.
+  auto visit = [&](const size_t& cell, const size_t& parent) {
+    nodes_[cell].parent = parent;
+    if(cell == parent) {
+      nodes_[cell].depth = 0;
+      nodes_[cell].jump = cell;
+    } else {
+      nodes_[cell].depth = nodes_[parent].depth + 1;
+      const size_t j = nodes_[parent].jump;
+      nodes_[cell].jump =
+          nodes_[parent].depth - nodes_[j].depth
+          == nodes_[j].depth - nodes_[nodes_[j].jump].depth ? nodes_[j].jump : parent;
+    }
+    order[tail++] = cell;
+  };
+  size_t next_root = 0;
+  size_t cell;
+  visit(root, root);
+  for(size_t head = 0; head < n; ++head) {
+    if(head == tail) {
+      // root's component is done, start the next one.
+      while(nodes_[next_root].depth != kNoPath) {
+        ++next_root;
+      }
+      visit(next_root, next_root);
+    }
+    cell = order[head];
+    if(cell % columns != 0 && !maze.HasRightWall(cell-1)
+       && nodes_[cell-1].depth == kNoPath) {
+      visit(cell-1, cell);
+    }
+    if(cell >= columns && !maze.HasBottomWall(cell-columns)
+       && nodes_[cell-columns].depth == kNoPath) {
+      visit(cell-columns, cell);
+    }
+    if(!maze.HasRightWall(cell) && nodes_[cell+1].depth == kNoPath) {
+      visit(cell+1, cell);
+    }
+    if(!maze.HasBottomWall(cell) && nodes_[cell+columns].depth == kNoPath) {
+      visit(cell+columns, cell);
+    }
+  }
+}
+
+size_t MazeTree::Lca(size_t a, size_t b) const {
+  if(nodes_[a].depth < nodes_[b].depth) {
+    swap(a, b);
+  }
+  a = Ancestor(a, nodes_[b].depth);
+  // a and b stay at equal depths, where jump targets have equal depths too.
+  while(a != b) {
+    if(nodes_[a].depth == 0) {
+      return kNoPath; // two different roots
+    }
+    if(nodes_[a].jump != nodes_[b].jump) {
+      a = nodes_[a].jump;
+      b = nodes_[b].jump;
+    } else {
+      a = nodes_[a].parent;
+      b = nodes_[b].parent;
+    }
+  }
+  return a;
+}
+
+size_t MazeTree::PathLength(const size_t& a, const size_t& b) const {
+  const size_t lca = Lca(a, b);
+  if(lca == kNoPath) {
+    return kNoPath;
+  }
+  return nodes_[a].depth + nodes_[b].depth - 2*nodes_[lca].depth;
+}
+
+bool MazeTree::Path(const size_t& a, const size_t& b, vector<size_t>* path) const {
+  path->clear();
+  const size_t lca = Lca(a, b);
+  if(lca == kNoPath) {
+    return false;
+  }
+  for(size_t cell = a; cell != lca; cell = nodes_[cell].parent) {
+    path->push_back(cell);
+  }
+  path->push_back(lca);
+  const size_t climb = path->size();
+  for(size_t cell = b; cell != lca; cell = nodes_[cell].parent) {
+    path->push_back(cell);
+  }
+  reverse(path->begin() + climb, path->end());
+  return true;
+}
+
+size_t MazeTree::Ancestor(size_t cell, const size_t& depth) const {
+  while(nodes_[cell].depth > depth) {
+    const Node& node = nodes_[cell];
+    cell = nodes_[node.jump].depth >= depth ? node.jump : node.parent;
+  }
+  return cell;
+}
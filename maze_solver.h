@@ -0,0 +1,270 @@
+// Created by Wei Shi
+// Path finding over generated mazes.
+#ifndef MAZE_SOLVER_H
+#define MAZE_SOLVER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "maze.h"
+#include "packed_path.h"
+
+using namespace std;
+
+/**
+* Strategy interface for finding a shortest path between two cells.
+* Solvers keep their scratch arrays between calls, so reusing one solver
+* avoids allocation. A solver is not thread safe, use one per thread.
+*/
+class MazeSolver {
+  public:
+    virtual ~MazeSolver() {}
+    // @param start is the index of the starting cell.
+    // @param end is the index of the ending cell.
+    // @param path gets the cells from start to end, both included, or is
+    // cleared if end can't be reached from start.
+    // @return true if end was reached.
+    virtual bool Solve(const Maze& maze, const size_t& start, const size_t& end,
+                       vector<size_t>* path) = 0;
+    // Same as Solve with the path packed 2 bits per move. Solvers that can
+    // write moves straight from their search state override it, the
+    // default packs the cells Solve returns.
+    // @param path gets the moves from start to end, or is cleared.
+    virtual bool SolvePacked(const Maze& maze, const size_t& start,
+                             const size_t& end, PackedPath* path);
+    virtual string name() const = 0;
+    // @return number of cells whose neighbors the last Solve examined.
+    size_t expanded() const { return expanded_; }
+
+  protected:
+    size_t expanded_ = 0;
+};
+
+/**
+* Breadth first search with flat scratch arrays.
+* Parents live in a dense array indexed by cell, visited cells in a bitset
+* and the queue in a preallocated array that is never reallocated, since
+* every cell is enqueued at most once. The arrays are sized on the first
+* Solve and kept, so later Solves on mazes of the same size allocate
+* nothing.
+*/
+class BfsSolver : public MazeSolver {
+  public:
+    BfsSolver() {}
+
+    bool Solve(const Maze& maze, const size_t& start, const size_t& end,
+               vector<size_t>* path) override;
+    // Walks the parents back from end pushing moves, then reverses the
+    // moves, so no array of cells is built.
+    bool SolvePacked(const Maze& maze, const size_t& start, const size_t& end,
+                     PackedPath* path) override;
+    string name() const override { return "bfs"; }
+
+  private:
+    // Searches from start until end is reached.
+    // @return true if end was reached, its parents then lead to start.
+    bool Search(const Maze& maze, const size_t& start, const size_t& end);
+    // Sizes the scratch arrays for maze and clears the visited bits.
+    void Prepare(const Maze& maze);
+    bool IsVisited(const size_t& cell) const {
+      return (visited_[cell >> 6] >> (cell & 63)) & 1;
+    }
+    void Visit(const size_t& cell, const size_t& parent) {
+      visited_[cell >> 6] |= 1ULL << (cell & 63);
+      parent_[cell] = parent;
+      queue_[tail_++] = cell;
+    }
+
+    vector<size_t> parent_; // cell the search reached each cell from
+    vector<uint64_t> visited_; // one bit per cell
+    vector<size_t> queue_; // cells in the order they were reached
+    size_t tail_;
+};
+
+/**
+* A* search with the Manhattan distance to end as heuristic. The heuristic
+* never overestimates in a grid, so paths are shortest, and on mazes with
+* loops far fewer cells are expanded than by breadth first search.
+* A move changes the distance to end by exactly one, so the estimated
+* length of a path through an open cell is either the current minimum F or
+* F+2. The open list is therefore two stacks instead of a heap, and popping
+* the most recent cell first breaks ties toward deeper cells.
+* Per-cell state is tagged with the number of the Solve that wrote it, so
+* a new Solve starts without clearing anything.
+*/
+class AStarSolver : public MazeSolver {
+  public:
+    AStarSolver() : search_(0) {}
+
+    bool Solve(const Maze& maze, const size_t& start, const size_t& end,
+               vector<size_t>* path) override;
+    string name() const override { return "astar"; }
+
+  private:
+    struct Node {
+      size_t parent;
+      size_t cost; // moves from start
+      uint32_t seen; // search that reached the cell, cost and parent are valid
+      uint32_t closed; // search that expanded the cell
+    };
+
+    vector<Node> nodes_;
+    vector<size_t> open_; // open cells estimated at F
+    vector<size_t> later_; // open cells estimated at F+2
+    uint32_t search_;
+};
+
+/**
+* Two breadth first searches, one from each end, that expand whole levels
+* of the smaller frontier in turn and stop at the level where they meet.
+* Each search covers about half the distance, so on mazes with loops the
+* cells expanded drop from the area of one disk of radius d to that of two
+* disks of radius d/2. State is tagged per Solve like AStarSolver's.
+*/
+class BidirectionalSolver : public MazeSolver {
+  public:
+    BidirectionalSolver() : search_(0) {}
+
+    bool Solve(const Maze& maze, const size_t& start, const size_t& end,
+               vector<size_t>* path) override;
+    string name() const override { return "bidirectional"; }
+
+  private:
+    struct Node {
+      size_t parent;
+      size_t distance; // moves from the side's end
+      uint32_t seen; // search that reached the cell
+      unsigned char side; // 0 for the search from start, 1 from end
+    };
+
+    // Expands every cell of frontier by one move.
+    // @return the best meeting (cell of side, neighbor of the other side)
+    // found, or (SIZE_MAX, SIZE_MAX).
+    pair<size_t, size_t> ExpandLevel(const Maze& maze, const unsigned char& side,
+                                     vector<size_t>* frontier,
+                                     vector<size_t>* next);
+
+    vector<Node> nodes_;
+    vector<size_t> frontiers_[2];
+    vector<size_t> next_;
+    uint32_t search_;
+};
+
+/**
+* Breadth first search on bitsets, 64 cells of a row per word.
+* The open right and bottom walls are copied into row aligned bitplanes,
+* then a whole word of the frontier moves at once: right and left with a
+* shift masked by the open right walls, up and down by masking with the
+* open bottom walls of the row above or of the row itself. Only words the
+* frontier touches are visited, so sparse frontiers cost no more than a
+* word each. Cells keep their level mod 3 in two more bitplanes, enough to
+* tell the previous level from the next one when walking back from end.
+* Memory is about one byte per cell. Paths equal BfsSolver's on perfect
+* mazes, on braided mazes they are equally short.
+*/
+class BitParallelSolver : public MazeSolver {
+  public:
+    BitParallelSolver() : words_per_row_(0) {}
+
+    bool Solve(const Maze& maze, const size_t& start, const size_t& end,
+               vector<size_t>* path) override;
+    string name() const override { return "bitparallel"; }
+
+  private:
+    // Copies the open walls of maze into row aligned planes and clears the
+    // search planes.
+    void Prepare(const Maze& maze);
+    bool Test(const vector<uint64_t>& plane, const size_t& row,
+              const size_t& col) const {
+      return (plane[row*words_per_row_ + (col >> 6)] >> (col & 63)) & 1;
+    }
+    // @return level mod 3 of a visited cell.
+    unsigned int Level(const size_t& row, const size_t& col) const {
+      return Test(level_low_, row, col) | Test(level_high_, row, col) << 1;
+    }
+
+    size_t words_per_row_;
+    vector<uint64_t> open_right_; // bit set if the right wall is open
+    vector<uint64_t> open_down_; // bit set if the bottom wall is open
+    vector<uint64_t> visited_;
+    vector<uint64_t> frontier_;
+    vector<uint64_t> next_;
+    vector<uint64_t> level_low_; // bit 0 of level mod 3
+    vector<uint64_t> level_high_; // bit 1 of level mod 3
+    vector<size_t> active_; // words of frontier_ with cells in them
+    vector<size_t> next_active_;
+};
+
+// Distance of cells that can't be reached, see ComputeDistanceField.
+const uint32_t kUnreachable = UINT32_MAX;
+
+// Level synchronous breadth first search from source on num_threads
+// threads. Each level's frontier is split into chunks that threads take in
+// turn, and cells are claimed with an atomic fetch_or on a bitset, so the
+// result does not depend on the number of threads. Levels of a few
+// thousand cells are not worth a barrier and run on one thread. A level
+// whose frontier holds more than 1/14 of the unvisited cells and 1/24 of
+// all cells is searched bottom up instead: every unvisited cell looks for
+// a neighbor on the frontier, which is cheaper when most cells would be
+// reached anyway. Maze frontiers are thin, so this happens mostly on
+// braided mazes with wide open areas.
+// @param distance gets the number of moves from source to every cell, or
+// kUnreachable. Four bytes per cell, so mazes are limited to 2^32-1 moves.
+void ComputeDistanceField(const Maze& maze, const size_t& source,
+                          const size_t& num_threads, vector<uint32_t>* distance);
+
+// @param name is one of bfs, astar, bidirectional or bitparallel.
+// @return the solver, or nullptr if name is unknown.
+unique_ptr<MazeSolver> MakeSolver(const string& name);
+
+// @return names accepted by MakeSolver.
+vector<string> SolverNames();
+
+/**
+* Rooted form of a perfect maze for answering many path queries.
+* Construction is one breadth first search that records every cell's parent
+* and depth, plus one jump pointer per cell chosen so that any ancestor is
+* reached in O(log n) jumps. The lowest common ancestor of two cells then
+* takes O(log n), and the path between them is the climb from each cell up
+* to it, so a query costs O(log n) plus the length of the path returned.
+* Memory is three words per cell, against n log n for binary lifting.
+* A maze that is not connected becomes a forest, one tree per component.
+* Paths are shortest only if the maze is perfect.
+*/
+class MazeTree {
+  public:
+    static const size_t kNoPath = SIZE_MAX;
+
+    // @param root is the cell the tree of root's component hangs from.
+    // Every other component hangs from its lowest cell.
+    explicit MazeTree(const Maze& maze, const size_t& root = 0);
+
+    // @return the deepest cell that is an ancestor of both a and b, or
+    // kNoPath if they are in different components.
+    size_t Lca(size_t a, size_t b) const;
+    // @return number of moves between a and b, or kNoPath.
+    size_t PathLength(const size_t& a, const size_t& b) const;
+    // @param path gets the cells from a to b, both included, or is cleared
+    // if they are in different components.
+    // @return true if b can be reached from a.
+    bool Path(const size_t& a, const size_t& b, vector<size_t>* path) const;
+
+    size_t parent(const size_t& cell) const { return nodes_[cell].parent; }
+    size_t depth(const size_t& cell) const { return nodes_[cell].depth; }
+    size_t size() const { return nodes_.size(); }
+
+  private:
+    // The fields a climb reads together share a cache line.
+    struct Node {
+      size_t parent; // roots are their own parent
+      size_t depth; // moves from the root
+      size_t jump; // skew binary jump pointer to an ancestor
+    };
+
+    // @return the ancestor of cell at depth, which must be at most cell's.
+    size_t Ancestor(size_t cell, const size_t& depth) const;
+
+    vector<Node> nodes_;
+};
+
+#endif
@@ -0,0 +1,136 @@
+#include <cstring>
+#include <iostream>
+
+#include "packed_path.h"
+using namespace std;
+
+bool PackedPath::PushCell(const size_t& cell) {
+  if(cell == last_ + 1 && columns_ > 1 && last_ % columns_ != columns_ - 1) {
+    Push(kRight);
+  } else if(cell == last_ + columns_) {
+    Push(kDown);
+  } else if(cell + 1 == last_ && columns_ > 1 && cell % columns_ != columns_ - 1) {
+    Push(kLeft);
+  } else if(cell + columns_ == last_) {
+    Push(kUp);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void PackedPath::Reverse() {
+  vector<uint64_t> reversed(words_.size(), 0);
+  for(size_t i = 0; i < moves_; ++i) {
+    const size_t j = moves_ - 1 - i;
+    reversed[i >> 5] |= (uint64_t)(move(j) ^ 2) << (2*(i & 31));
+  }
+  words_.swap(reversed);
+  swap(start_, last_);
+}
+
+PathWriter::~PathWriter() {
+  if(output_ != nullptr) {
+    fclose(output_);
+  }
+}
+
+bool PathWriter::Open(const string& filename, const size_t& start,
+                      const size_t& columns) {
+  if(output_ != nullptr) {
+    fclose(output_);
+  }
+  output_ = fopen(filename.c_str(), "wb");
+  if(output_ == nullptr) {
+    cout << "PathWriter: cannot open file" << endl;
+    return false;
+  }
+  setvbuf(output_, nullptr, _IOFBF, 1 << 20);
+  moves_ = 0;
+  byte_ = 0;
+  fprintf(output_, "MAZEPATH\n%zu %zu ", columns, start);
+  moves_offset_ = ftell(output_);
+  // fixed width, so Close can overwrite it in place.
+  fprintf(output_, "%020zu\n", (size_t)0);
+  return true;
+}
+
+bool PathWriter::Write(const PackedPath::Move& move) {
+  if(output_ == nullptr) {
+    return false;
+  }
+  byte_ |= move << (2*(moves_ & 3));
+  if((++moves_ & 3) == 0) {
+    if(fputc(byte_, output_) == EOF) {
+      cout << "PathWriter: could not write" << endl;
+      return false;
+    }
+    byte_ = 0;
+  }
+  return true;
+}
+
+bool PathWriter::Close() {
+  if(output_ == nullptr) {
+    return false;
+  }
+  bool ok = (moves_ & 3) == 0 || fputc(byte_, output_) != EOF;
+  ok = ok && fseek(output_, moves_offset_, SEEK_SET) == 0
+       && fprintf(output_, "%020zu", moves_) == 20;
+  ok = fclose(output_) == 0 && ok;
+  output_ = nullptr;
+  if(!ok) {
+    cout << "PathWriter: could not write" << endl;
+  }
+  return ok;
+}
+
+bool WritePath(const string& filename, const PackedPath& path) {
+  if(path.empty()) {
+    return false;
+  }
+  PathWriter writer;
+  if(!writer.Open(filename, path.start(), path.columns())) {
+    return false;
+  }
+  for(size_t i = 0; i < path.moves(); ++i) {
+    if(!writer.Write(path.move(i))) {
+      return false;
+    }
+  }
+  return writer.Close();
+}
+
+bool ReadPath(const string& filename, PackedPath* path) {
+  FILE* input = fopen(filename.c_str(), "rb");
+  if(input == nullptr) {
+    cout << "ReadPath: cannot open file " << filename << endl;
+    return false;
+  }
+  // header lines are read whole, the moves after them may look like
+  // whitespace to fscanf.
+  char line[96];
+  size_t columns, start, moves;
+  const bool header = fgets(line, sizeof(line), input) != nullptr
+                      && strcmp(line, "MAZEPATH\n") == 0
+                      && fgets(line, sizeof(line), input) != nullptr
+                      && sscanf(line, "%zu %zu %zu", &columns, &start, &moves) == 3;
+  if(!header) {
+    cout << "ReadPath: " << filename << " is not a path file" << endl;
+    fclose(input);
+    return false;
+  }
+  *path = PackedPath(start, columns);
+  int byte = 0;
+  for(size_t i = 0; i < moves; ++i) {
+    if((i & 3) == 0 && (byte = fgetc(input)) == EOF) {
+      cout << "ReadPath: " << filename << " is too short" << endl;
+      fclose(input);
+      path->Clear();
+      return false;
+    }
+    path->Push((PackedPath::Move)((byte >> (2*(i & 3))) & 3));
+  }
+  fclose(input);
+  return true;
+}
@@ -0,0 +1,171 @@
+// Created by Wei Shi
+// Paths through a maze stored as their first cell and 2 bits per move.
+#ifndef PACKED_PATH_H
+#define PACKED_PATH_H
+
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+* Path between two cells of a maze with the given number of columns, kept
+* as its first cell and one 2 bit move per step, 32 moves per word. A path
+* of a million moves takes 250KB where a forward_list<size_t> of its cells
+* takes a node allocation per cell. Cells are decoded one at a time by the
+* iterator, so walking the path never expands it in memory.
+*/
+class PackedPath {
+  public:
+    // Moves are numbered so that right and down match the wall index of
+    // the cell they leave, and every move's opposite is move ^ 2.
+    enum Move : unsigned int { kRight = 0, kDown = 1, kLeft = 2, kUp = 3 };
+
+    // Walks the cells of a path in order, from start() to last().
+    class const_iterator {
+      public:
+        typedef forward_iterator_tag iterator_category;
+        typedef size_t value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const size_t* pointer;
+        typedef const size_t& reference;
+
+        const_iterator(const PackedPath* path, const size_t& cell,
+                       const size_t& index)
+            : path_(path), cell_(cell), index_(index) {}
+        const size_t& operator*() const { return cell_; }
+        const_iterator& operator++() {
+          if(index_ < path_->moves()) {
+            cell_ = path_->Step(cell_, path_->move(index_));
+          }
+          ++index_;
+          return *this;
+        }
+        bool operator==(const const_iterator& rhs) const {
+          return index_ == rhs.index_;
+        }
+        bool operator!=(const const_iterator& rhs) const {
+          return index_ != rhs.index_;
+        }
+
+      private:
+        const PackedPath* path_;
+        size_t cell_;
+        size_t index_; // number of the cell, cell_ is valid below size()
+    };
+
+    // An empty path, with no cells.
+    PackedPath(): start_(0), last_(0), columns_(0), moves_(0), empty_(true) {}
+    // A path of the single cell start.
+    // @param columns is the number of columns of the maze.
+    PackedPath(const size_t& start, const size_t& columns)
+        : start_(start), last_(start), columns_(columns), moves_(0),
+          empty_(false) {}
+
+    // Extends the path by one move from last().
+    void Push(const Move& move) {
+      if((moves_ & 31) == 0) {
+        words_.push_back(0);
+      }
+      words_.back() |= (uint64_t)move << (2*(moves_ & 31));
+      ++moves_;
+      last_ = Step(last_, move);
+    }
+    // Extends the path to cell, which must be next to last().
+    // @return false if cell is not next to last(), the path is unchanged.
+    bool PushCell(const size_t& cell);
+    // Turns the path around, so it goes from last() to start().
+    void Reverse();
+    void Clear() {
+      words_.clear();
+      start_ = last_ = moves_ = 0;
+      empty_ = true;
+    }
+
+    // @return the i-th move, i below moves().
+    Move move(const size_t& i) const {
+      return (Move)((words_[i >> 5] >> (2*(i & 31))) & 3);
+    }
+    // @return the cell one move away from cell.
+    size_t Step(const size_t& cell, const Move& move) const {
+      switch(move) {
+        case kRight: return cell + 1;
+        case kDown: return cell + columns_;
+        case kLeft: return cell - 1;
+        default: return cell - columns_;
+      }
+    }
+
+    const_iterator begin() const { return const_iterator(this, start_, 0); }
+    const_iterator end() const { return const_iterator(this, last_, size()); }
+    size_t start() const { return start_; }
+    size_t last() const { return last_; }
+    size_t columns() const { return columns_; }
+    // @return number of moves, one less than the number of cells.
+    size_t moves() const { return moves_; }
+    // @return number of cells.
+    size_t size() const { return empty_ ? 0 : moves_ + 1; }
+    bool empty() const { return empty_; }
+    // @return bytes taken by the moves.
+    size_t bytes() const { return words_.size() * sizeof(uint64_t); }
+    // @return the words of moves, move i in bits 2*(i%32) of word i/32.
+    const vector<uint64_t>& words() const { return words_; }
+
+  private:
+    size_t start_;
+    size_t last_;
+    size_t columns_;
+    size_t moves_;
+    bool empty_;
+    vector<uint64_t> words_;
+};
+
+/**
+* Writes a path to a file one move at a time, so a path can be streamed out
+* while it is produced and never held whole. The file is the text header
+*   MAZEPATH
+*   <columns> <start> <moves>
+* followed by the moves, 4 per byte from the lowest bits up. The number of
+* moves is filled in by Close.
+*/
+class PathWriter {
+  public:
+    PathWriter(): output_{nullptr}, moves_{0}, byte_{0}, moves_offset_{0} {}
+    PathWriter(const PathWriter&) = delete;
+    PathWriter& operator=(const PathWriter&) = delete;
+    ~PathWriter();
+
+    // Creates filename and writes the header.
+    // @param start is the first cell of the path.
+    // @param columns is the number of columns of the maze.
+    // @return true if everything is OK, false otherwise.
+    bool Open(const string& filename, const size_t& start, const size_t& columns);
+    // Appends one move.
+    // @return true if everything is OK, false otherwise.
+    bool Write(const PackedPath::Move& move);
+    // Writes the last partial byte and the number of moves and closes the
+    // file.
+    // @return true if everything is OK, false otherwise.
+    bool Close();
+
+    size_t moves() const { return moves_; }
+
+  private:
+    FILE* output_;
+    size_t moves_;
+    unsigned char byte_; // moves not yet written, moves_ % 4 of them
+    long moves_offset_; // file position of the number of moves
+};
+
+// Streams path to filename with a PathWriter.
+// @return true if everything is OK, false if path is empty or on I/O error.
+bool WritePath(const string& filename, const PackedPath& path);
+
+// Reads a file written by PathWriter.
+// @return true if everything is OK, false otherwise.
+bool ReadPath(const string& filename, PackedPath* path);
+
+#endif
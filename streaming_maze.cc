@@ -0,0 +1,149 @@
+#include <iostream>
+#include "maze_render.h"
+#include "streaming_maze.h"
+
+using namespace std;
+
+namespace {
+
+const size_t kNoColumn = static_cast<size_t>(-1);
+
+// Expands a line of unit pixels (one per cell or wall) by scale in both
+// directions and writes it to output.
+bool WriteUnitLine(const vector<unsigned char>& unit_line, const size_t& scale,
+                   vector<unsigned char>* scanline, PgmWriter* output) {
+  ScaleUnitLine(unit_line.data(), unit_line.size(), scale, scanline->data());
+  for(size_t y = 0; y < scale; ++y) {
+    if(!output->WriteRow(scanline->data())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+EllerGenerator::EllerGenerator(const size_t& rows, const size_t& cols,
+                               const uint64_t& seed)
+    : num_rows_(rows), num_columns_(cols), current_row_(0),
+      labels_(cols), columns_(cols), first_column_(2*cols),
+      openings_(cols), chosen_(cols), gen_(seed) {
+  // labels below cols name sets carried down from the previous row, labels
+  // from cols up are fresh sets.
+  for(size_t j = 0; j < num_columns_; ++j) {
+    labels_[j] = num_columns_ + j;
+  }
+}
+
+size_t EllerGenerator::FindColumn(size_t j) {
+  while(columns_[j] != j) {
+    columns_[j] = columns_[columns_[j]]; // path halving
+    j = columns_[j];
+  }
+  return j;
+}
+
+bool EllerGenerator::NextRow(vector<char>* right_walls, vector<char>* bottom_walls) {
+  if(current_row_ >= num_rows_ || num_columns_ == 0) {
+    return false;
+  }
+  right_walls->assign(num_columns_, true);
+  bottom_walls->assign(num_columns_, true);
+  const bool last_row = current_row_ == num_rows_ - 1;
+
+  // Cells sharing a label start in one set, rooted at its first column.
+  fill(first_column_.begin(), first_column_.end(), kNoColumn);
+  for(size_t j = 0; j < num_columns_; ++j) {
+    if(first_column_[labels_[j]] == kNoColumn) {
+      first_column_[labels_[j]] = j;
+    }
+    columns_[j] = first_column_[labels_[j]];
+  }
+
+  size_t root, neighbor_root;
+  for(size_t j = 0; j + 1 < num_columns_; ++j) {
+    root = FindColumn(j);
+    neighbor_root = FindColumn(j+1);
+    if(root != neighbor_root && (last_row || gen_.Coin())) {
+      (*right_walls)[j] = false;
+      columns_[neighbor_root] = root;
+    }
+  }
+  ++current_row_;
+  if(last_row) {
+    return true;
+  }
+
+  // openings_ counts bottom openings per set, first_column_ is reused to count
+  // members so chosen_ can hold a uniformly sampled fallback opening.
+  fill(openings_.begin(), openings_.end(), 0);
+  fill(first_column_.begin(), first_column_.begin() + num_columns_, 0);
+  for(size_t j = 0; j < num_columns_; ++j) {
+    root = FindColumn(j);
+    if(gen_.Coin()) {
+      (*bottom_walls)[j] = false;
+      ++openings_[root];
+    }
+    ++first_column_[root];
+    if(gen_.Below(first_column_[root]) == 0) {
+      chosen_[root] = j;
+    }
+  }
+  for(size_t j = 0; j < num_columns_; ++j) {
+    if(FindColumn(j) == j && openings_[j] == 0) {
+      (*bottom_walls)[chosen_[j]] = false;
+    }
+  }
+
+  for(size_t j = 0; j < num_columns_; ++j) {
+    labels_[j] = (*bottom_walls)[j] ? num_columns_ + j : FindColumn(j);
+  }
+  return true;
+}
+
+bool WriteStreamingMaze(const size_t& rows, const size_t& cols,
+                        const size_t& scale, const string& output,
+                        const uint64_t& seed) {
+  if(rows == 0 || cols == 0) {
+    cout << "Maze is empty. Please initialize its dimensions." << endl;
+    return false;
+  }
+  const size_t unit_col_size = (2*cols)+1;
+  PgmWriter writer;
+  if(!writer.Open(output, scale*((2*rows)+1), scale*unit_col_size, 255)) {
+    return false;
+  }
+
+  vector<unsigned char> unit_line(unit_col_size, kWallShade);
+  vector<unsigned char> scanline(scale*unit_col_size);
+  unit_line[1] = kOpenShade; // create starting point
+  if(!WriteUnitLine(unit_line, scale, &scanline, &writer)) {
+    return false;
+  }
+
+  EllerGenerator generator(rows, cols, seed);
+  vector<char> right_walls, bottom_walls;
+  size_t row = 0;
+  while(generator.NextRow(&right_walls, &bottom_walls)) {
+    // line through the cells and their right walls
+    for(size_t j = 0; j < cols; ++j) {
+      unit_line[(2*j)+1] = kOpenShade;
+      unit_line[(2*j)+2] = right_walls[j] ? kWallShade : kOpenShade;
+    }
+    if(!WriteUnitLine(unit_line, scale, &scanline, &writer)) {
+      return false;
+    }
+    // line through the bottom walls and the corners between them
+    for(size_t j = 0; j < cols; ++j) {
+      unit_line[(2*j)+1] = bottom_walls[j] ? kWallShade : kOpenShade;
+      unit_line[(2*j)+2] = kWallShade;
+    }
+    if(++row == rows) {
+      unit_line[unit_col_size-2] = kOpenShade; // create ending point
+    }
+    if(!WriteUnitLine(unit_line, scale, &scanline, &writer)) {
+      return false;
+    }
+  }
+  return writer.Close();
+}
@@ -0,0 +1,68 @@
+// Created by Wei Shi
+// Streaming maze generator that never holds more than one row of cells.
+#ifndef STREAMING_MAZE_H
+#define STREAMING_MAZE_H
+
+#include <string>
+#include <vector>
+#include "image.h"
+#include "utility_methods.h"
+
+using namespace std;
+using namespace image;
+
+/**
+* ELLER'S ALGORITHM:
+*   1. Give every cell of the current row that has no set yet its own set.
+*   2. Randomly join horizontally adjacent cells that are in different sets.
+*   3. Randomly open bottom walls, at least one per set, so every set carries
+*      on into the next row. Cells below an opening keep the set.
+*   4. Repeat for every row. On the last row join all adjacent cells that are
+*      still in different sets and open no bottom walls.
+*
+*   Only the set labels of the current row are kept, so memory is O(columns)
+*   whatever the number of rows. The result is a perfect maze like
+*   Maze::Generate's.
+*/
+class EllerGenerator {
+  public:
+    // @param rows is the number of rows of cells.
+    // @param cols is the number of columns of cells.
+    // @param seed determines the maze.
+    explicit EllerGenerator(const size_t& rows, const size_t& cols,
+                            const uint64_t& seed);
+
+    // Generates the next row of cells.
+    // @param right_walls gets cols flags, true if the cell has a right wall.
+    // @param bottom_walls gets cols flags, true if the cell has a bottom wall.
+    // @return false once all rows have been generated.
+    bool NextRow(vector<char>* right_walls, vector<char>* bottom_walls);
+    size_t num_rows() const { return num_rows_; }
+    size_t num_columns() const { return num_columns_; }
+
+  private:
+    // @return root of column j in the per-row set of columns.
+    size_t FindColumn(size_t j);
+
+    size_t num_rows_;
+    size_t num_columns_;
+    size_t current_row_;
+    vector<size_t> labels_; // set label of each cell in the current row
+    vector<size_t> columns_; // per-row union-find over column positions
+    vector<size_t> first_column_; // first column seen with a label
+    vector<size_t> openings_; // bottom openings per set root
+    vector<size_t> chosen_; // fallback bottom opening per set root
+    CounterRng gen_;
+};
+
+// Generates a rows*cols maze with Eller's algorithm and writes each finished
+// row of cells to output as scaled scanlines. Produces the same image layout
+// as Maze::get_image.
+// @param scale is the length in pixels of a square cell.
+// @param seed determines the maze.
+// @return true if everything is OK, false otherwise.
+bool WriteStreamingMaze(const size_t& rows, const size_t& cols,
+                        const size_t& scale, const string& output,
+                        const uint64_t& seed);
+
+#endif
@@ -1,26 +1,132 @@
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <thread>
 #include "utility_methods.h"
 using namespace std;
 
-vector<size_t> SampleRandomIndex(size_t size) {
+namespace {
+
+// SplitMix64 finalizer, a bijection on 64 bit words.
+uint64_t Mix(uint64_t z) {
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+// Runs task(0), ..., task(count-1) on up to num_threads threads.
+template <typename Task>
+void RunParallel(const size_t& count, const size_t& num_threads, Task task) {
+  atomic<size_t> next(0);
+  auto worker = [&]() {
+    size_t i;
+    while((i = next.fetch_add(1)) < count) {
+      task(i);
+    }
+  };
+  vector<thread> threads;
+  for(size_t t = 1; t < min(num_threads, count); ++t) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for(auto& t: threads) {
+    t.join();
+  }
+}
+
+}  // namespace
+
+CounterRng::CounterRng(const uint64_t& seed, const uint64_t& counter)
+    : key_(Mix(seed + 0x9e3779b97f4a7c15ULL)), counter_(counter) {}
+
+CounterRng::result_type CounterRng::At(const uint64_t& counter) const {
+  return Mix(Mix(counter*0x9e3779b97f4a7c15ULL + key_) ^ key_);
+}
+
+FeistelPermutation::FeistelPermutation(const uint64_t& size, const uint64_t& seed)
+    : size_(size), half_bits_(1), rng_(seed) {
+  while(half_bits_ < 32 && (1ULL << (2*half_bits_)) < size_) {
+    ++half_bits_;
+  }
+  half_mask_ = (1ULL << half_bits_) - 1;
+}
+
+uint64_t FeistelPermutation::Encrypt(uint64_t x) const {
+  uint64_t left = x >> half_bits_;
+  uint64_t right = x & half_mask_;
+  uint64_t mixed;
+  for(uint64_t round = 0; round < 4; ++round) {
+    mixed = left ^ (rng_.At((right << 2) | round) & half_mask_);
+    left = right;
+    right = mixed;
+  }
+  return (left << half_bits_) | right;
+}
+
+uint64_t RandomSeed() {
   random_device rd;
-  mt19937 gen(rd());
-  vector<size_t> indices;
-  for(size_t i = 0; i < size; ++i) {
-    indices.push_back(i);
-  }
-  vector<size_t> result;
-  size_t chosen_value;
-  size_t current_right;
-  size_t chosen_index;
-  for(size_t i = 1; i <= indices.size(); ++i) {
-    current_right = indices.size()-i;
-    uniform_int_distribution<> dist(0,current_right);
-    chosen_index = dist(gen);
-    chosen_value = indices[chosen_index];
-    indices[chosen_index] = indices[current_right];
-    result.push_back(chosen_value);
+  return ((uint64_t)rd() << 32) ^ rd();
+}
+
+uint64_t DeriveSeed(const uint64_t& seed, const uint64_t& stream) {
+  return CounterRng(seed).At(stream ^ 0x5851f42d4c957f2dULL);
+}
+
+vector<size_t> SampleRandomIndex(size_t size, const uint64_t& seed,
+                                 const size_t& num_threads) {
+  // MergeShuffle: Fisher-Yates shuffles fixed size blocks, then neighboring
+  // shuffled runs are riffled together level by level. Every block and every
+  // merge draws from its own counter-based stream, so the work can be spread
+  // over any number of threads and the permutation only depends on seed.
+  const size_t block_size = 1 << 16;
+  vector<size_t> indices(size);
+  iota(indices.begin(), indices.end(), 0);
+
+  const size_t blocks = (size + block_size - 1) / block_size;
+  RunParallel(blocks, num_threads, [&](const size_t& block) {
+    CounterRng rng(DeriveSeed(seed, block));
+    const size_t first = block*block_size;
+    const size_t last = min(first + block_size, size);
+    for(size_t k = first + 1; k < last; ++k) {
+      swap(indices[k], indices[first + rng.Below(k - first + 1)]);
+    }
+  });
+
+  uint64_t level = 0;
+  for(size_t width = block_size; width < size; width *= 2, ++level) {
+    const uint64_t level_seed = DeriveSeed(seed, ~level);
+    RunParallel((size + 2*width - 1) / (2*width), num_threads,
+                [&](const size_t& pair) {
+      const size_t first = pair*2*width;
+      const size_t middle = first + width;
+      const size_t last = min(first + 2*width, size);
+      if(middle >= last) {
+        return;
+      }
+      CounterRng rng(DeriveSeed(level_seed, pair));
+      size_t i = first;
+      size_t j = middle;
+      // Each position takes the next element of a coin-chosen run until
+      // one run is used up.
+      while(true) {
+        if(rng.Coin()) {
+          if(j == last) {
+            break;
+          }
+          swap(indices[i], indices[j++]);
+        } else if(i == j) {
+          break;
+        }
+        ++i;
+      }
+      // The rest is placed with Fisher-Yates insertions, which keeps the
+      // merged run uniform.
+      for(; i < last; ++i) {
+        swap(indices[i], indices[first + rng.Below(i - first + 1)]);
+      }
+    });
   }
-  return result;
+  return indices;
 }
 
 bool IsUnsignedNumber(const string& s) {
@@ -1,12 +1,113 @@
 #ifndef UTILITY_METHODS_H
 #define UTILITY_METHODS_H
 
+#include <atomic>
+#include <cstdint>
 #include <vector>
 #include <random>
 #include <string>
+#include <thread>
 using namespace std;
 
-vector<size_t> SampleRandomIndex(size_t size);
+/**
+ * Counter-based random number generator.
+ * The n-th number of a stream depends only on the seed and n, so threads can
+ * draw from any position without sharing state and a seed reproduces the
+ * same numbers whatever the number of threads. Each number is the counter
+ * mixed with a seed-derived key through two SplitMix64 style rounds.
+ * Satisfies UniformRandomBitGenerator, but Below and Coin should be
+ * preferred to std distributions, whose output differs between libraries.
+ */
+class CounterRng {
+  public:
+    typedef uint64_t result_type;
+    explicit CounterRng(const uint64_t& seed, const uint64_t& counter = 0);
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT64_MAX; }
+    result_type operator()() { return At(counter_++); }
+    // @return the number at position counter of this stream.
+    result_type At(const uint64_t& counter) const;
+    // @return a number in [0, bound) for bound > 0.
+    uint64_t Below(const uint64_t& bound) {
+      return (uint64_t)(((unsigned __int128)(*this)() * bound) >> 64);
+    }
+    bool Coin() { return ((*this)() >> 63) != 0; }
+
+  private:
+    uint64_t key_;
+    uint64_t counter_;
+};
+
+/**
+ * Seeded pseudo-random bijection on [0, size) that needs no storage.
+ * A balanced four round Feistel network with CounterRng round functions
+ * permutes the smallest power of four covering size, and cycle walking
+ * maps the result back into [0, size). Position i of the random order is
+ * operator()(i), so the whole permutation never has to be materialized.
+ */
+class FeistelPermutation {
+  public:
+    explicit FeistelPermutation(const uint64_t& size, const uint64_t& seed);
+    // @param i is a position in [0, size).
+    // @return the element at position i of the permutation.
+    uint64_t operator()(uint64_t i) const {
+      do {
+        i = Encrypt(i);
+      } while(i >= size_);
+      return i;
+    }
+    uint64_t size() const { return size_; }
+
+  private:
+    uint64_t Encrypt(uint64_t x) const;
+
+    uint64_t size_;
+    unsigned int half_bits_;
+    uint64_t half_mask_;
+    CounterRng rng_;
+};
+
+/**
+ * Reusable barrier for a fixed number of threads. The last thread to
+ * arrive runs the completion before releasing the others, so it can change
+ * shared state that every thread reads after the barrier.
+ */
+class SpinBarrier {
+  public:
+    explicit SpinBarrier(const size_t& count)
+        : count_(count), arrived_(0), generation_(0) {}
+
+    template <typename Completion>
+    void Wait(Completion completion) {
+      const size_t generation = generation_.load(memory_order_acquire);
+      if(arrived_.fetch_add(1, memory_order_acq_rel) + 1 == count_) {
+        completion();
+        arrived_.store(0, memory_order_relaxed);
+        generation_.fetch_add(1, memory_order_release);
+        return;
+      }
+      while(generation_.load(memory_order_acquire) == generation) {
+        this_thread::yield();
+      }
+    }
+
+  private:
+    const size_t count_;
+    atomic<size_t> arrived_;
+    atomic<size_t> generation_;
+};
+
+// @return a seed from random_device for callers that did not pick one.
+uint64_t RandomSeed();
+// @return a seed for an independent stream number stream of seed.
+uint64_t DeriveSeed(const uint64_t& seed, const uint64_t& stream);
+
+// @return a uniformly random permutation of [0, size) determined only by
+// seed. The shuffle runs in place on num_threads threads and any thread count
+// gives the same result.
+vector<size_t> SampleRandomIndex(size_t size, const uint64_t& seed,
+                                 const size_t& num_threads = 1);
 bool IsUnsignedNumber(const string& s);
 size_t StringToSizeT(string s);
 